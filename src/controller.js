@@ -1,7 +1,7 @@
 const readline = require('readline');
 const fs = require('fs');
+const path = require('path');
 const Bottleneck = require('bottleneck');
-const Combinatorics = require('js-combinatorics');
 const parameter = require('./parameter');
 const program = require('./program');
 const Lattice = require('./lattice');
@@ -10,6 +10,29 @@ const logger = require('./logger')('controller');
 const makeLattice = async (argv, N) => {
   logger.debug('Creating lattice');
   const lattice = new Lattice(N);
+  for (const [i, j] of argv.requires || []) {
+    logger.debug('Register the dependency', i, j);
+    if (!await lattice.require(i, j))
+      logger.warning('Dependency dropped, as it closes a cycle:', i, j);
+  }
+  for (const [i, j] of argv.excludes || []) {
+    logger.debug('Register the mutual exclusion', i, j);
+    await lattice.exclude(i, j);
+  }
+  for (const [i, ...js] of argv.same || []) {
+    logger.debug('Register the interchangeable parameters', i, js);
+    for (const j of js)
+      if (!await lattice.same(i, j))
+        logger.warning('Interchangeable parameters conflict with dependencies:', i, j);
+  }
+  if (argv.exhaust) {
+    logger.debug('Enumerate the remaining solutions by dualization');
+    await lattice.dualize();
+  }
+  if (argv.quorum > 1) {
+    logger.debug('Settle conflicting results by a quorum of', argv.quorum);
+    await lattice.quorum(argv.quorum);
+  }
   if (argv.inf) {
     logger.debug('Register the top of the lattice as true');
     await lattice.report('1'.repeat(N), true);
@@ -30,24 +53,83 @@ const makeLattice = async (argv, N) => {
   return lattice;
 };
 
+// Options that decide what running a configuration means, and so what
+// its result says; runs differing in any of them share no results
+const meaning = [
+  'program', 'args', 'cwd', 'xargs', 'split', 'inPlace', 'one', 'co', 'contra',
+  'zero', 'nonZero', 'stdout', 'stderr', 'timeout', 'timeLimit',
+];
+// Unset and off are the same
+const optionKey = (v) => JSON.stringify(v === undefined || v === false ? null : v);
+
+// Results of an earlier run, as far as they still hold: TRUE is upward
+// closed, so it survives if all of its parameters are still there;
+// FALSE is downward closed, so it survives on those that are still there
+const warmStart = async (argv, pars, lattice) => {
+  let prior;
+  try {
+    prior = JSON.parse(await fs.promises.readFile(argv.warmStart, 'utf-8'));
+  } catch (e) {
+    logger.error('Cannot read the earlier result file, starting cold:', e);
+    return;
+  }
+  if (!prior.lattice || !prior.pars || !prior.argv) {
+    logger.warning('No lattice in the earlier result file, starting cold');
+    return;
+  }
+  const diff = meaning.filter((k) => optionKey(prior.argv[k]) !== optionKey(argv[k]));
+  if (diff.length) {
+    logger.warning('The earlier run differs in what its results mean, starting cold:', diff);
+    return;
+  }
+  const remap = parameter.remap(pars);
+  const t = prior.lattice.true.map((ps) => remap(ps, false)).filter(Boolean);
+  const f = prior.lattice.false.map((ps) => remap(ps, true)).filter(Boolean);
+  const z = prior.lattice.improbable.map((ps) => remap(ps, false)).filter(Boolean);
+  logger.debug('Earlier results mapped onto the parameters:', t.length, f.length, z.length);
+  let n = await lattice.seed(t, f, z);
+  // The lower end of a region is mapped like a true result, the upper like a false
+  for (const [lo, hi] of prior.lattice.regions || []) {
+    const l = remap(lo, false);
+    const h = remap(hi, true);
+    if (l && h && await lattice.region(l, h)) n++;
+  }
+  logger.notice('Warm start: reused', n, 'earlier results');
+};
+
 const run = async (argv, lattice, runner) => {
   const running = {};
+  const tried = new Set();
   const queue = [];
   await lattice.log();
   let maybeNext = true;
+  const cancel = (list) => {
+    if (!list.length) return;
+    logger.info('Cancelling # trival executions:', list.length);
+    list.forEach((c) => {
+      const r = running[c];
+      if (r && r.token && r.token.cancel) {
+        r.token.cancel();
+        delete running[c];
+      } else {
+        logger.warning('Execution already quitted:', c);
+      }
+    });
+  };
   const check = async () => {
     if (queue.length)
       logger.debug('Checking reports');
     while (queue.length) {
       maybeNext = true;
-      const { cfg, result } = queue.splice(0, 1)[0];
+      const { cfg, result, duration } = queue.splice(0, 1)[0];
       logger.info(`Reporting ${result} to #`, cfg);
       delete running[cfg];
-      if (!await lattice.report(cfg, result)) {
+      if (!await lattice.report(cfg, result, duration)) {
         logger.error('Assumption violation found, ignoring the result of #', cfg);
         logger.notice('Execution result of that was:', result);
       } else {
         logger.debug('Report accepted by lattice regarding #', cfg);
+        cancel(await lattice.cancelled());
       }
     }
   };
@@ -76,21 +158,16 @@ const run = async (argv, lattice, runner) => {
         maybeNext = false;
         break;
       }
-      if (n.cancel.length) {
-        logger.info('Cancelling # trival executions:', n.cancel.length);
-        n.cancel.forEach((c) => {
-          const r = running[c];
-          if (r && r.token && r.token.cancel) {
-            r.token.cancel();
-            delete running[c];
-          } else {
-            logger.warning('Execution already quitted:', c);
-          }
-        });
-      }
-      const hash = parameter.hash(argv, n.start);
-      logger.info('Starting new execution:', n.start);
-      runner(n.start, hash, running[n.start] = {}, queue);
+      cancel(n.cancel);
+      const hash = parameter.hash(argv, n.start, await lattice.hash(n.start));
+      // Only disputed results are ever asked for again
+      const fresh = tried.has(n.start);
+      tried.add(n.start);
+      if (fresh)
+        logger.info('Starting re-execution of a disputed result:', n.start);
+      else
+        logger.info('Starting new execution:', n.start);
+      runner(n.start, hash, running[n.start] = { fresh }, queue);
     }
 
     if (!argv.exhaust) {
@@ -119,6 +196,9 @@ const run = async (argv, lattice, runner) => {
   logger.debug('Double check to see if we have missing sup and inf');
   await lattice.finalize();
   await lattice.log();
+  await lattice.listTwins();
+  for (const str of ['true', 'improbable', 'false'])
+    await lattice.listImpl(logger.trace, str);
 
   if (argv.sup) {
     if (lattice.summary.suprema) {
@@ -140,16 +220,50 @@ const run = async (argv, lattice, runner) => {
 
 const picks = (pars, val) => (c) => pars.filter((v, i) => c[i] === val);
 
+// The lattice only visits one representative per --same group; give back
+// every configuration with the same number of parameters from each group
+const expands = (groups, limit = 1024) => (c) => {
+  let res = [c];
+  for (const g of groups) {
+    const k = g.filter((i) => c[i] === '1').length;
+    const next = [];
+    const pick = (from, left, cfg) => {
+      if (next.length >= limit) return;
+      if (!left) {
+        next.push(cfg);
+        return;
+      }
+      for (let t = from; t <= g.length - left; t++) {
+        const a = [...cfg];
+        a[g[t]] = '1';
+        pick(t + 1, left - 1, a.join(''));
+      }
+    };
+    for (const r of res) {
+      const a = [...r];
+      g.forEach((i) => { a[i] = '0'; });
+      pick(0, k, a.join(''));
+    }
+    res = next;
+  }
+  if (res.length >= limit)
+    logger.warning('Too many configurations, only the first', limit, 'are shown for', c);
+  return res;
+};
+
 const flow = (reverse) => async (argv, pars) => {
   logger.info('Use lattice strategy');
   const pick = picks(pars, '1');
+  const expand = expands(argv.same || []);
   const lattice = await makeLattice(argv, pars.length);
+  if (argv.warmStart)
+    await warmStart(argv, pars, lattice);
 
   const counter = {};
   const lcounter = [];
   const startTime = +new Date();
   await run(argv, lattice, async (cfg, hash, exec, queue) => {
-    exec.token = {};
+    exec.token = { fresh: exec.fresh };
     const ps = pick(cfg);
     exec.promise = program.execute(argv, ps, hash, exec.token);
     const res = await exec.promise;
@@ -166,19 +280,26 @@ const flow = (reverse) => async (argv, pars) => {
       case 'fail':
         const r = !!((res === 'success') ^ reverse);
         logger.debug(`Will report ${r} for #`, hash);
-        queue.push({ cfg, result: r });
+        queue.push({ cfg, result: r, duration: exec.token.duration });
         break;
       case 'disaster':
       case 'error':
         logger.debug('Will report improbable for #', hash);
-        queue.push({ cfg, result: null });
+        queue.push({ cfg, result: null, duration: exec.token.duration });
         break;
     }
   });
   const endTime = +new Date();
 
+  const twins = lattice.twins.map((g) => g.map((i) => pars[i]));
+  twins.forEach((g) => {
+    logger.notice('These parameters behaved interchangeably, consider --same:', g);
+  });
+  const suprema = argv.sup ? lattice.suprema.flatMap(expand) : [];
+  const infima = argv.inf ? lattice.infima.flatMap(expand) : [];
+
   if (argv.sup) {
-    lattice.suprema.forEach((c) => {
+    suprema.forEach((c) => {
       logger.info('Found supremum:', c);
       logger.notice('Found supremum:', {
         hash: parameter.hash(argv, c),
@@ -187,7 +308,7 @@ const flow = (reverse) => async (argv, pars) => {
     });
   }
   if (argv.inf) {
-    lattice.infima.forEach((c) => {
+    infima.forEach((c) => {
       logger.info('Found infimum:', c);
       logger.notice('Found infimum:', {
         hash: parameter.hash(argv, c),
@@ -211,8 +332,15 @@ const flow = (reverse) => async (argv, pars) => {
     counter,
     lcounter,
     summary: lattice.summary,
-    suprema: lattice.suprema.map(pick),
-    infima: lattice.infima.map(pick),
+    suprema: suprema.map(pick),
+    infima: infima.map(pick),
+    twins,
+    lattice: {
+      true: lattice.true.map(pick),
+      improbable: lattice.improbable.map(pick),
+      false: lattice.false.map(pick),
+      regions: lattice.regions.map((r) => r.map(pick)),
+    },
   };
   logger.trace('Report:', report);
   return report;
@@ -221,29 +349,66 @@ const flow = (reverse) => async (argv, pars) => {
 module.exports.covariant = flow(false);
 module.exports.contravariant = flow(true);
 
+// Where an interrupted brute-force run of the same shard stopped, and
+// what it found up to there
+const resume = async (argv, pars) => {
+  let prior;
+  try {
+    prior = JSON.parse(await fs.promises.readFile(argv.warmStart, 'utf-8'));
+  } catch (e) {
+    logger.error('Cannot read the earlier result file, starting over:', e);
+    return null;
+  }
+  if (!prior.argv || !prior.counter || typeof prior.position !== 'number') {
+    logger.warning('No enumeration in the earlier result file, starting over');
+    return null;
+  }
+  const diff = [...meaning, 'shard'].filter((k) => optionKey(prior.argv[k]) !== optionKey(argv[k]));
+  if (JSON.stringify(prior.pars) !== JSON.stringify(pars))
+    diff.push('pars');
+  if (diff.length) {
+    logger.warning('The earlier run enumerated something else, starting over:', diff);
+    return null;
+  }
+  return prior;
+};
+
 module.exports.invariant = async (argv, pars) => {
   logger.info('Use brute-force strategy');
   const limiter = new Bottleneck({
     maxConcurrent: argv.maxProcs,
   });
-  const pick = picks(pars, true);
+  const pick = picks(pars, '1');
+  const lattice = new Lattice(pars.length);
 
   const startTime = +new Date();
-  logger.info('Started enumeration');
-  await new Promise((resolve) => { setTimeout(resolve, 10); });
-  const cmb = Combinatorics.baseN([false, true], pars.length);
-  logger.info('Finished enumeration');
+  const [k, m] = argv.shard || [0, 1];
+  const total = await lattice.enumerate('gray', k, m);
+  logger.info(`Started enumeration of shard ${k}/${m}:`, total);
 
-  const counter = {};
-  const lcounter = [];
+  const prior = argv.warmStart ? await resume(argv, pars) : null;
+  const counter = prior ? prior.counter : {};
+  const lcounter = prior ? prior.lcounter : [];
   const results = {};
-  const promises = [];
-  cmb.forEach((acfg) => {
-    const ps = pick(acfg);
-    if (argv.one && !ps.length) return;
-    promises.push(limiter.schedule(async () => {
-      const cfg = acfg.map((v) => v ? '1' : '0').join('');
-      const res = await program.execute(argv, ps, parameter.hash(argv, cfg));
+  Object.keys(counter).forEach((res) => {
+    results[res] = prior[res] || [];
+  });
+  // Everything before it is accounted for in the above
+  let position = 0;
+  if (prior) {
+    position = prior.position;
+    await lattice.seek(position);
+    logger.notice('Resuming enumeration at:', position, total);
+  }
+
+  // Results finishing out of order wait here until all before them are in
+  const done = new Map();
+  const commit = () => {
+    while (done.has(position)) {
+      const r = done.get(position);
+      done.delete(position++);
+      if (!r) continue;
+      const { res, ps, hash } = r;
       if (!results[res]) {
         counter[res] = 0;
         results[res] = [];
@@ -254,16 +419,10 @@ module.exports.invariant = async (argv, pars) => {
       }
       lcounter[ps.length][res] = (lcounter[ps.length][res] || 0) + 1;
       results[res].push({ hash, p: ps });
-    }, null));
-  });
-  await Promise.all(promises);
-  const endTime = +new Date();
-
-  logger.notice('Summary of execution:', counter);
-  logger.info('Summary of execution by level:', lcounter);
+    }
+  };
 
-  logger.info('All steps completed, drafting report');
-  const report = {
+  const draft = (endTime) => ({
     version: process.env.npm_package_version,
     versions: process.versions,
     argv,
@@ -271,10 +430,65 @@ module.exports.invariant = async (argv, pars) => {
     startTime,
     endTime,
     duration: endTime - startTime,
+    position,
     counter,
     lcounter,
     ...results,
+  });
+  // Leave a result file to resume from, should the run be interrupted
+  const checkpoint = async () => {
+    if (!argv.resultFile) return;
+    const op = path.join(argv.output, argv.resultFile);
+    await fs.promises.writeFile(`${op}.tmp`, JSON.stringify(draft(+new Date()), null, 2), {
+      encoding: 'utf-8',
+      mode: '644',
+    });
+    await fs.promises.rename(`${op}.tmp`, op);
   };
+
+  // Configurations are streamed in batches, so memory stays bounded; the
+  // next batch is fetched while the previous one still fills every slot
+  const batchSize = argv.maxProcs * 16;
+  const pending = new Set();
+  let next = position;
+  while (true) {
+    const batch = await lattice.batch(batchSize);
+    if (!batch.length) break;
+    // One request at a time, as the binary backend cannot interleave them
+    const codes = [];
+    for (const cfg of batch)
+      codes.push(await lattice.hash(cfg));
+    batch.forEach((cfg, i) => {
+      const ord = next++;
+      const ps = pick(cfg);
+      if (argv.one && !ps.length) {
+        done.set(ord, null);
+        return;
+      }
+      const hash = parameter.hash(argv, cfg, codes[i]);
+      const p = limiter.schedule(() => program.execute(argv, ps, hash)).then((res) => {
+        pending.delete(p);
+        done.set(ord, { res, ps, hash });
+        commit();
+      });
+      pending.add(p);
+    });
+    commit();
+    while (pending.size > argv.maxProcs)
+      await Promise.race(pending);
+    await checkpoint();
+    logger.info('Enumeration position:', position, total);
+  }
+  await Promise.all(pending);
+  logger.info('Finished enumeration');
+  lattice.quit();
+  const endTime = +new Date();
+
+  logger.notice('Summary of execution:', counter);
+  logger.info('Summary of execution by level:', lcounter);
+
+  logger.info('All steps completed, drafting report');
+  const report = draft(endTime);
   logger.trace('Report:', report);
   return report;
 };
@@ -11,6 +11,7 @@ const mkdirp = require('mkdirp');
 const parameter = require('./parameter');
 const controller = require('./controller');
 const program = require('./program');
+const Lattice = require('./lattice');
 const logger = require('./logger')('main');
 
 const argv = yargs
@@ -47,7 +48,7 @@ const argv = yargs
     describe: 'At least one parameter is required to run the program.',
     type: 'boolean',
   })
-  .group(['arg-file', 'in-place', 'split'], 'Debug Parameter Control:')
+  .group(['arg-file', 'in-place', 'split', 'requires', 'excludes', 'same'], 'Debug Parameter Control:')
   .option('a', {
     alias: 'arg-file',
     describe: 'Read parameters from file instead of stdin.',
@@ -64,6 +65,24 @@ const argv = yargs
     type: 'boolean',
   })
   .implies('split', 'xargs')
+  .option('requires', {
+    describe: 'Parameter i (0-based) is useless without parameter j, given as i:j. Repeat or use commas for more.',
+    type: 'string',
+    requiresArg: 1,
+  })
+  .option('excludes', {
+    describe: 'Parameters i and j (0-based) cannot be used together, given as i:j. Repeat or use commas for more.',
+    type: 'string',
+    requiresArg: 1,
+  })
+  .option('same', {
+    describe: 'Parameters i,j,... (0-based) are interchangeable, so only the number of them used matters. Repeat for more groups.',
+    type: 'string',
+    requiresArg: 1,
+  })
+  .conflicts('requires', 'invariant')
+  .conflicts('same', 'invariant')
+  .conflicts('excludes', 'invariant')
   .group(['zero', 'non-zero', 'stdout', 'stderr', 'time-limit', 'timeout'], 'Success / Failure / Error Detection:')
   .option('z', {
     alias: 'zero',
@@ -111,7 +130,7 @@ const argv = yargs
     type: 'string',
     requiresArg: 1,
   })
-  .group(['sup', 'inf', 'exhaust', 'co', 'contra', 'invariant'], 'Searching Strategies and a priori Assumptions:')
+  .group(['sup', 'inf', 'exhaust', 'co', 'contra', 'invariant', 'shard', 'warm-start', 'quorum'], 'Searching Strategies and a priori Assumptions:')
   .option('M', {
     alias: ['sup', 'max'],
     describe: 'Search upwards: Get the largest / supremum subset(s).',
@@ -155,6 +174,22 @@ This option cannot be used together with --sup nor --inf. \
     type: 'boolean',
   })
   .conflicts('exhaust', 'invariant')
+  .option('shard', {
+    describe: 'With --invariant, only search the k-th (0-based) of m equal shares of the parameter space, given as k/m.',
+    type: 'string',
+    requiresArg: 1,
+  })
+  .implies('shard', 'invariant')
+  .option('warm-start', {
+    describe: 'Reuse the results of an earlier run, given its result file, as far as they hold for the current parameters. With --invariant, resume the enumeration where that run stopped.',
+    type: 'string',
+    requiresArg: 1,
+  })
+  .option('quorum', {
+    describe: 'Results contradicting earlier ones are executed again, along with those they contradict, until either side wins by this many runs. Without it (or with 1), they are ignored.',
+    type: 'number',
+  })
+  .conflicts('quorum', 'invariant')
   .group([
     'verbose',
     'quiet',
@@ -281,6 +316,38 @@ This option cannot be used together with --sup nor --inf. \
       throw new Error('Argument check failed: You cannot use --sup nor --inf if you use --invariant');
     return true;
   })
+  .check((argv) => {
+    // Left alone unless given, or they would conflict with --invariant
+    for (const k of ['requires', 'excludes']) {
+      if (argv[k] === undefined)
+        continue;
+      const l = [].concat(argv[k]).flatMap((s) => s.split(','));
+      argv[k] = l.map((s) => {
+        const m = s.match(/^([0-9]+):([0-9]+)$/);
+        if (!m || m[1] === m[2])
+          throw new Error(`Argument check failed: --${k} must be i:j with i != j`);
+        return [+m[1], +m[2]];
+      });
+    }
+    if (argv.same === undefined)
+      return true;
+    argv.same = [].concat(argv.same).map((s) => {
+      const l = s.split(',');
+      if (l.length < 2 || !l.every((v) => /^[0-9]+$/.test(v)))
+        throw new Error('Argument check failed: --same must be i,j,... with at least two parameters');
+      return l.map(Number);
+    });
+    return true;
+  })
+  .check((argv) => {
+    if (argv.shard === undefined)
+      return true;
+    const m = argv.shard.match(/^([0-9]+)\/([0-9]+)$/);
+    if (!m || +m[1] >= +m[2])
+      throw new Error('Argument check failed: --shard must be k/m with 0 <= k < m');
+    argv.shard = [+m[1], +m[2]];
+    return true;
+  })
   .check((argv) => {
     if (!(argv.zero === 'fail' || argv.nonZero === 'fail' || argv.timeout === 'fail' || argv.stdout === 'fail' || argv.stderr === 'fail'))
       throw new Error('Argument check failed: At least one of --zero, --non-zero, --timeout, --stdout, --stderr need to be \'fail\'');
@@ -504,6 +571,14 @@ module.exports = async () => {
       logger.fatal('At least one parameter is required');
       return 2;
     }
+    if (argv.invariant && pars.length > Lattice.maxEnumerate) {
+      logger.fatal(`--invariant cannot enumerate more than ${Lattice.maxEnumerate} parameters`);
+      return 2;
+    }
+    if ([...argv.requires || [], ...argv.excludes || [], ...argv.same || []].some((l) => l.some((i) => i >= pars.length))) {
+      logger.fatal('--requires / --excludes / --same refer to a non-existing parameter');
+      return 2;
+    }
   } catch (e) {
     logger.fatal('During parameter read:', e);
     return 1;
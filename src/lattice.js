@@ -2,6 +2,7 @@ const cp = require('child_process');
 const path = require('path');
 const fs = require('fs');
 const readline = require('readline');
+const { TextDecoder } = require('util');
 const logger = require('./logger')('lattice');
 
 const wasmPaths = [
@@ -35,6 +36,9 @@ const getGoodPaths = (orig) => {
   return { paths, good };
 }
 
+// Order of journal::kind in the lattice
+const kinds = ['true', 'suprema', 'improbable', 'infima', 'false', 'running', 'region'];
+
 class LatticeBase {
   async next(sup, inf) {
     for (let i = 0; i < 2; i++) {
@@ -76,82 +80,135 @@ class LatticeBase {
     );
 
     logger.debug('Number of running executions:', this.summary.running);
-    await this.listImpl(logger.debug, 'suprema', 'supremum');
-    await this.listImpl(logger.debug, 'infima', 'infimum');
+    if (this.summary.disputed)
+      logger.notice('Number of disputed results:', this.summary.disputed);
+    if (this.summary.overflow && !this.overflow) {
+      this.overflow = true;
+      logger.warning('Too many transversals, dualization gave up: --exhaust may miss some solutions');
+    }
+    await this.follow();
+  }
 
-    if (logger.getMaxLevel() < 6) return;
-    await this.listImpl(logger.trace, 'true');
-    await this.listImpl(logger.trace, 'improbable');
-    await this.listImpl(logger.trace, 'false');
-    await this.listImpl(logger.trace, 'running');
+  // Catch up with the changes to the lattice since the last call
+  async follow() {
+    const { version, entries } = await this.changesImpl(this.version || 0);
+    this.version = version;
+    if (!this.sets) this.sets = {};
+    let lo;
+    entries.forEach(({ kind, add, elem }) => {
+      // A region comes as its lower end, then its upper
+      if (kind === 'region') {
+        if (lo === undefined) {
+          lo = elem;
+          return;
+        }
+        [lo, elem] = [undefined, `${lo} ${elem}`];
+      }
+      if (!this.sets[kind]) this.sets[kind] = new Set();
+      if (add) this.sets[kind].add(elem);
+      else this.sets[kind].delete(elem);
+      const f = add && (kind === 'suprema' || kind === 'infima') ? logger.debug : logger.trace;
+      f(`${add ? '+' : '-'}${kind}:`, elem);
+    });
+    this.suprema = [...(this.sets.suprema || [])];
+    this.infima = [...(this.sets.infima || [])];
+    this.regions = [...(this.sets.region || [])].map((r) => r.split(' '));
   }
 }
 
 class LatticeWasm extends LatticeBase {
-  constructor() {
+  constructor(N) {
     super();
+    this.N = N;
     const { paths, good } = getGoodPaths(wasmPaths);
     if (!good.length) {
       logger.fatal('No valid lattice wasm found in:', paths);
       throw new Error('Cannot load lattice wasm');
     }
-    logger.debug('Loading lattice wasm from:', good[0]);
-    this.Module = require(good[0])().then((prog) => {
-      logger.debug('Lattice wasm loaded successfully');
-      return prog;
-    }).catch((e) => {
-      logger.error('Cannot load lattice wasm:', e);
-    });
+    if (!LatticeWasm.Module) {
+      logger.debug('Loading lattice wasm from:', good[0]);
+      LatticeWasm.Module = require(good[0])().then((prog) => {
+        logger.debug('Lattice wasm loaded successfully');
+        return prog;
+      }).catch((e) => {
+        logger.error('Cannot load lattice wasm:', e);
+      });
+    }
+    // Each instance owns an independent lattice inside the shared module
+    this.Module = LatticeWasm.Module.then((prog) => new prog.Lattice(N));
+  }
+
+  // Elements go in as packed 32-bit words in the wasm heap, and come back
+  // as '0'/'1' bytes, all of them decoded at once.
+  // Views returned by the module are only valid until the next call.
+  static encode(prog, elem) {
+    const view = prog.inbox(elem.length);
+    for (let i = 0; i < elem.length; i++)
+      if (elem[i] === '1')
+        view[i >>> 5] |= 1 << (i & 31);
   }
 
-  static toArray(vec) {
+  toArray(view) {
+    const s = LatticeWasm.text.decode(view);
     const res = [];
-    for (let i = 0; i < vec.size(); i++) {
-      const s = vec.get(i);
-      logger.trace('Read vector from lattice:', s);
-      res.push(s);
-    }
-    logger.trace('Finished read vector from lattice');
+    for (let o = 0; o < s.length; o += this.N)
+      res.push(s.slice(o, o + this.N));
+    logger.trace('Read from lattice:', res.length, 'vectors');
     return res;
   }
 
-  quit() { }
+  quit() {
+    this.Module.then((prog) => prog.delete());
+    if (this.Enumerator) this.Enumerator.then((en) => en.delete());
+  }
 
   async nextImpl(dir) {
     const prog = await this.Module;
-    logger.trace('Calling lattice:', `next_${dir}`);
-    const res = await prog[`next_${dir}`]();
+    logger.trace('Calling lattice:', `next_${dir}_raw`);
+    const [res] = this.toArray(prog[`next_${dir}_raw`]());
     logger.trace('Result from lattice:', res);
     return res;
   }
 
   async cancelled() {
     const prog = await this.Module;
-    logger.trace('Calling lattice:', 'cancelled');
-    const res = LatticeWasm.toArray(await prog.cancelled());
+    logger.trace('Calling lattice:', 'cancelled_raw');
+    const res = this.toArray(prog.cancelled_raw());
     logger.trace('Result from lattice:', res);
     return res;
   }
 
-  async report(elem, val) {
+  async report(elem, val, duration) {
     const prog = await this.Module;
-    if (val === true) {
-      logger.trace('Calling lattice:', 'mark_true');
-      logger.trace('Parameter of which:', elem);
-      const res = prog.mark_true(elem);
-      logger.trace('Result from lattice:', res);
-      return res;
-    }
-    if (val === false) {
-      logger.trace('Calling lattice:', 'mark_true');
-      logger.trace('Parameter of which:', elem);
-      const res = prog.mark_false(elem);
-      logger.trace('Result from lattice:', res);
-      return res;
-    }
-    logger.trace('Calling lattice:', 'mark_improbable');
-    logger.trace('Parameter of which:', elem);
-    const res = prog.mark_improbable(elem);
+    const t = duration === undefined ? -1 : duration;
+    const f = val === true ? 'mark_true_raw' : val === false ? 'mark_false_raw' : 'mark_improbable_raw';
+    logger.trace('Calling lattice:', f);
+    logger.trace('Parameter of which:', elem, t);
+    LatticeWasm.encode(prog, elem);
+    const res = prog[f](t);
+    logger.trace('Result from lattice:', res);
+    return res;
+  }
+
+  // Same as parameter.hash, without the program name
+  async hash(elem) {
+    const prog = await this.Module;
+    LatticeWasm.encode(prog, elem);
+    return prog.hash_raw();
+  }
+
+  async seed(t, f, z) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'seed', t.length, f.length, z.length);
+    const res = prog.seed(t.join('\n'), f.join('\n'), z.join('\n'));
+    logger.trace('Result from lattice:', res);
+    return res;
+  }
+
+  async region(lo, hi) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'mark_region', lo, hi);
+    const res = prog.mark_region(lo, hi);
     logger.trace('Result from lattice:', res);
     return res;
   }
@@ -163,19 +220,104 @@ class LatticeWasm extends LatticeBase {
     logger.trace('Result from lattice:', null);
   }
 
+  async dualize() {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'dualize');
+    await prog.dualize();
+    logger.trace('Result from lattice:', null);
+  }
+
+  async quorum(q) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'quorum', q);
+    await prog.quorum(q);
+    logger.trace('Result from lattice:', null);
+  }
+
+  async require(i, j) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'require', i, j);
+    const res = prog.require(i, j);
+    logger.trace('Result from lattice:', res);
+    return res;
+  }
+
+  async exclude(i, j) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'exclude', i, j);
+    const res = prog.exclude(i, j);
+    logger.trace('Result from lattice:', res);
+    return res;
+  }
+
+  async same(i, j) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'same', i, j);
+    const res = prog.same(i, j);
+    logger.trace('Result from lattice:', res);
+    return res;
+  }
+
+  async listTwins() {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'list_twins');
+    const v = prog.list_twins();
+    this.twins = [];
+    for (let i = 0; i < v.size(); i++)
+      this.twins.push(v.get(i).split(' ').map(Number));
+    v.delete();
+    logger.trace('Result from lattice:', this.twins);
+  }
+
   async listImpl(f, str, singular) {
     const prog = await this.Module;
     this[str] = [];
-    logger.trace('Calling lattice:', `list_${str}`);
-    LatticeWasm.toArray(await prog[`list_${str}`]()).forEach((s) => {
+    logger.trace('Calling lattice:', `list_${str}_raw`);
+    this.toArray(prog[`list_${str}_raw`]()).forEach((s) => {
       this[str].push(s);
       f(`${singular || str}:`, s);
     });
   }
 
+  async enumerate(order, k, m) {
+    const prog = await LatticeWasm.Module;
+    logger.trace('Calling lattice:', 'Enumerator', order, k, m);
+    if (this.Enumerator) (await this.Enumerator).delete();
+    this.Enumerator = Promise.resolve(new prog.Enumerator(this.N, order === 'level', k, m));
+    return (await this.Enumerator).size();
+  }
+
+  async seek(pos) {
+    (await this.Enumerator).seek(pos);
+  }
+
+  async position() {
+    return (await this.Enumerator).position();
+  }
+
+  async batch(n) {
+    logger.trace('Calling lattice:', 'batch_raw', n);
+    return this.toArray((await this.Enumerator).batch_raw(n));
+  }
+
+  async changesImpl(v) {
+    const prog = await this.Module;
+    logger.trace('Calling lattice:', 'changes_raw', v);
+    const els = this.toArray(prog.changes_raw(v));
+    const tags = prog.changes_tags();
+    const entries = els.map((elem, i) => ({
+      kind: kinds[tags[i] >>> 1],
+      add: !!(tags[i] & 1),
+      elem,
+    }));
+    const version = prog.version();
+    logger.trace('Result from lattice:', version, entries.length);
+    return { version, entries };
+  }
+
   async summaryImpl() {
     const prog = await this.Module;
-    logger.trace('Calling lattice:', 'summary');
+    logger.trace('Calling lattice:', 'summary_raw');
     const [
       t,
       suprema,
@@ -185,7 +327,9 @@ class LatticeWasm extends LatticeBase {
       running,
       bestHierU,
       bestHierD,
-    ] = LatticeWasm.toArray(await prog.summary());
+      disputed,
+      overflow,
+    ] = prog.summary_raw();
     this.summary = {
       true: t,
       suprema,
@@ -195,9 +339,15 @@ class LatticeWasm extends LatticeBase {
       running,
       bestHierU,
       bestHierD,
+      disputed,
+      overflow,
     };
   }
 }
+// One decoder for every view the module hands out
+LatticeWasm.text = new TextDecoder();
+// Enumerator positions travel as doubles
+LatticeWasm.maxEnumerate = 53;
 
 class LatticeBinary extends LatticeBase {
   constructor(N) {
@@ -207,6 +357,7 @@ class LatticeBinary extends LatticeBase {
       logger.fatal('No valid lattice binary found in:', paths);
       throw new Error('Cannot load lattice binary');
     }
+    this.N = N;
     logger.debug('Spawning lattice binary from:', good[0]);
     this.prog = cp.spawn(good[0], [N], {
       stdio: ['pipe', 'pipe', 'inherit'],
@@ -223,9 +374,32 @@ class LatticeBinary extends LatticeBase {
       this.lines.push(line);
       if (this.check) this.check();
     });
+    // Long elements travel as hex digits, 4 bits each
+    this.hex = N > 64;
+    if (this.hex) {
+      this.prog.stdin.write('format hex\n');
+      this.ready = this.rlRead();
+    }
+  }
+
+  enc(elem) {
+    if (!this.hex) return elem;
+    let s = '';
+    for (let i = 0; i < elem.length; i += 4)
+      s += parseInt(elem.substr(i, 4).padEnd(4, '0'), 2).toString(16);
+    return s;
+  }
+
+  dec(s) {
+    if (!this.hex || !s) return s;
+    let elem = '';
+    for (const c of s)
+      elem += parseInt(c, 16).toString(2).padStart(4, '0');
+    return elem.slice(0, this.N);
   }
 
   async rlWrite(s) {
+    await this.ready;
     logger.trace('Write to lattice:', s);
     await this.prog.stdin.write(s + '\n');
   }
@@ -261,39 +435,121 @@ class LatticeBinary extends LatticeBase {
 
   async nextImpl(dir) {
     await this.rlWrite(`next ${dir}`);
-    return this.rlRead();
+    return this.dec(await this.rlRead());
   }
 
   async cancelled() {
     await this.rlWrite('cancelled');
-    return this.rlReads();
+    return (await this.rlReads()).map((s) => this.dec(s));
   }
 
-  async report(elem, val) {
+  async report(elem, val, duration) {
     if (val === true) await this.rlWrite('true');
     else if (val === false) await this.rlWrite('false');
     else await this.rlWrite('improbable');
-    await this.rlWrite(elem);
+    const e = this.enc(elem);
+    await this.rlWrite(duration === undefined ? e : `${e} ${duration}`);
     const s = +await this.rlRead();
     return !!s;
   }
 
+  async seed(t, f, z) {
+    await this.rlWrite(`seed ${t.length} ${f.length} ${z.length}`);
+    for (const e of [...t, ...f, ...z])
+      await this.rlWrite(this.enc(e));
+    return +await this.rlRead();
+  }
+
+  async region(lo, hi) {
+    await this.rlWrite('region');
+    await this.rlWrite(`${this.enc(lo)} ${this.enc(hi)}`);
+    return !!+await this.rlRead();
+  }
+
+  async hash(elem) {
+    await this.rlWrite('hash');
+    await this.rlWrite(this.enc(elem));
+    return this.rlRead();
+  }
+
   async finalize() {
     await this.rlWrite('finalize');
     await this.rlRead();
   }
 
+  async dualize() {
+    await this.rlWrite('dualize');
+    await this.rlRead();
+  }
+
+  async quorum(q) {
+    await this.rlWrite(`quorum ${q}`);
+    await this.rlRead();
+  }
+
+  async require(i, j) {
+    await this.rlWrite(`require ${i} ${j}`);
+    return !!+await this.rlRead();
+  }
+
+  async exclude(i, j) {
+    await this.rlWrite(`exclude ${i} ${j}`);
+    return !!+await this.rlRead();
+  }
+
+  async same(i, j) {
+    await this.rlWrite(`same ${i} ${j}`);
+    return !!+await this.rlRead();
+  }
+
+  async listTwins() {
+    await this.rlWrite('list twins');
+    this.twins = (await this.rlReads()).map((s) => s.split(' ').map(Number));
+  }
+
   async listImpl(f, str, singular) {
     this[str] = [];
     await this.rlWrite(`list ${str}`);
     while (true) {
-      const s = await this.rlRead();
+      const s = this.dec(await this.rlRead());
       if (!s) break;
       this[str].push(s);
       f(`${singular || str}:`, s);
     }
   }
 
+  async enumerate(order, k, m) {
+    await this.rlWrite(`enumerate ${order} ${k} ${m}`);
+    const res = await this.rlRead();
+    if (!res) throw new Error(`Cannot enumerate ${this.N} parameters`);
+    return +res;
+  }
+
+  async seek(pos) {
+    await this.rlWrite(`seek ${pos}`);
+    await this.rlRead();
+  }
+
+  async position() {
+    await this.rlWrite('position');
+    return +await this.rlRead();
+  }
+
+  async batch(n) {
+    await this.rlWrite(`batch ${n}`);
+    return (await this.rlReads()).map((s) => this.dec(s));
+  }
+
+  async changesImpl(v) {
+    await this.rlWrite(`changes since ${v}`);
+    const version = +await this.rlRead();
+    const entries = (await this.rlReads()).map((l) => {
+      const [tag, elem] = l.split(' ');
+      return { kind: tag.slice(1), add: tag[0] === '+', elem: this.dec(elem) };
+    });
+    return { version, entries };
+  }
+
   async summaryImpl() {
     await this.rlWrite('summary');
     this.summary = {
@@ -305,8 +561,13 @@ class LatticeBinary extends LatticeBase {
       running: +await this.rlRead(),
       bestHierU: +await this.rlRead(),
       bestHierD: +await this.rlRead(),
+      disputed: +await this.rlRead(),
+      overflow: +await this.rlRead(),
     };
   }
 }
 
+// Enumerator positions are 64-bit
+LatticeBinary.maxEnumerate = 63;
+
 module.exports = process.env.FINDBUG_USE_BINARY ? LatticeBinary : LatticeWasm;
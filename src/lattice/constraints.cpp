@@ -0,0 +1,153 @@
+#include "constraints.hpp"
+#include <algorithm>
+
+bool admits(const constraints &cs, const elem &el, size_t i) {
+    return cs.admits(el, i);
+}
+
+void constraints::touch(size_t N, size_t i) {
+    if (!_n) {
+        _n = N;
+        _req.resize(N), _dep.resize(N), _exc.resize(N);
+    }
+    if (_req[i])
+        return;
+    _req[i] = _dep[i] = _exc[i] = elem::bottom(N);
+    _bits.push_back(i);
+}
+
+bool constraints::require(size_t N, size_t i, size_t j) {
+    if (i >= N || j >= N || i == j || (_n && _n != N))
+        return false;
+    touch(N, i);
+    touch(N, j);
+    if (_req[j].test(i))
+        return false;
+    if (_req[i].test(j))
+        return true;
+
+    // Everything needing i now needs j and everything j needs
+    auto r = _req[j];
+    r.flip(j);
+    auto d = _dep[i];
+    d.flip(i);
+    for (auto a : _bits)
+        if (d.test(a))
+            _req[a] |= r;
+    for (auto b : _bits)
+        if (r.test(b))
+            _dep[b] |= d;
+    return true;
+}
+
+bool constraints::exclude(size_t N, size_t i, size_t j) {
+    if (i >= N || j >= N || i == j || (_n && _n != N))
+        return false;
+    touch(N, i);
+    touch(N, j);
+    if (!_exc[i].test(j))
+        _exc[i].flip(j), _exc[j].flip(i);
+    return true;
+}
+
+size_t constraints::find(size_t i) const {
+    while (_rep[i] != i)
+        i = _rep[i];
+    return i;
+}
+
+bool constraints::merge(size_t N, size_t i, size_t j) {
+    if (i >= N || j >= N || i == j || (_n && _n != N))
+        return false;
+    // Restored if the chain closes a cycle, so that a rejected merge leaves no trace
+    auto old = *this;
+    if (_rep.empty())
+        for (size_t k{ 0 }; k < N; k++)
+            _rep.push_back(k);
+    auto ri = find(i), rj = find(j);
+    if (ri == rj)
+        return true;
+    _rep[std::max(ri, rj)] = std::min(ri, rj);
+
+    // Chain the class in order, each one requiring its predecessor
+    for (size_t k{ 0 }, prev{ N }; k < N; k++) {
+        if (find(k) != std::min(ri, rj))
+            continue;
+        if (prev != N && !require(N, k, prev)) {
+            *this = std::move(old);
+            return false;
+        }
+        prev = k;
+    }
+    return true;
+}
+
+bool constraints::empty() const {
+    return _bits.empty();
+}
+
+bool constraints::valid(const elem &el) const {
+    for (auto a : _bits)
+        if (el.test(a) && (!(_req[a] <= el) || (_exc[a] & el).hier()))
+            return false;
+    return true;
+}
+
+bool constraints::admits(const elem &el, size_t i) const {
+    if (_bits.empty() || !_req[i])
+        return true;
+    if (el.test(i))
+        return !(_dep[i] & el).hier();
+    return _req[i] <= el && !(_exc[i] & el).hier();
+}
+
+std::vector<elem> constraints::floor(const elem &el) const {
+    std::vector<elem> res, st{ el };
+    while (!st.empty() && res.size() < cap) {
+        auto x = std::move(st.back());
+        st.pop_back();
+
+        // Transitivity makes a single pass enough
+        for (auto a : _bits)
+            if (x.test(a) && !(_req[a] <= x))
+                x.flip(a);
+
+        // Split on the first conflict: drop either side with its dependents
+        auto flag = true;
+        for (auto a : _bits) {
+            if (!x.test(a))
+                continue;
+            auto it = std::find_if(_bits.begin(), _bits.end(), [&](size_t b) {
+                return x.test(b) && _exc[a].test(b);
+            });
+            if (it == _bits.end())
+                continue;
+            for (auto v : { a, *it }) {
+                auto d = _dep[v];
+                d.flip(v);
+                st.push_back(x & ~d);
+            }
+            flag = false;
+            break;
+        }
+        if (flag)
+            res.push_back(std::move(x));
+    }
+
+    std::vector<elem> max;
+    for (const auto &x : res)
+        if (std::none_of(res.begin(), res.end(), [&](const elem &y) { return x != y && x <= y; })
+            && std::find(max.begin(), max.end(), x) == max.end())
+            max.push_back(x);
+    return max;
+}
+
+std::vector<elem> constraints::ceil(const elem &el) const {
+    auto x = el;
+    for (auto a : _bits)
+        if (el.test(a))
+            x |= _req[a];
+    if (!valid(x))
+        return {};
+    return { x };
+}
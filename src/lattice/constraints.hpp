@@ -0,0 +1,48 @@
+#ifndef LATTICE_CONSTRAINTS_HPP
+#define LATTICE_CONSTRAINTS_HPP
+
+#include <vector>
+#include "elem.hpp"
+
+// Dependencies and mutual exclusions between bits.
+// An element is valid if each of its bits has all the bits it requires
+// and none of the bits it excludes. Valid elements are closed under &,
+// and any two comparable ones are joined by a chain of single flips,
+// so searching them only takes filtering the usual neighbors.
+class constraints {
+    size_t _n{ 0 };
+    // Per bit, empty if unconstrained:
+    // _req: bits it requires, transitively
+    // _dep: bits requiring it, transitively
+    // _exc: bits it excludes
+    std::vector<elem> _req, _dep, _exc;
+    // Bits with any of the above
+    std::vector<size_t> _bits;
+    // Union-find over interchangeable bits, empty if none
+    std::vector<size_t> _rep;
+
+    [[nodiscard]] size_t find(size_t i) const;
+
+    void touch(size_t N, size_t i);
+
+public:
+    static constexpr size_t cap{ 16384 };
+
+    // Fails on a cycle, which would make the bits inseparable
+    [[nodiscard]] bool require(size_t N, size_t i, size_t j);
+    [[nodiscard]] bool exclude(size_t N, size_t i, size_t j);
+    // Interchangeable bits: only the first k of a class may be set, so
+    // that each count per class is searched once instead of per subset
+    [[nodiscard]] bool merge(size_t N, size_t i, size_t j);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] bool valid(const elem &el) const;
+    [[nodiscard]] bool admits(const elem &el, size_t i) const;
+
+    // The largest valid elements below el, at most cap of them
+    [[nodiscard]] std::vector<elem> floor(const elem &el) const;
+    // The smallest valid element above el, if any
+    [[nodiscard]] std::vector<elem> ceil(const elem &el) const;
+};
+
+#endif //LATTICE_CONSTRAINTS_HPP
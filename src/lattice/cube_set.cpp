@@ -0,0 +1,121 @@
+#include "cube_set.hpp"
+#include <algorithm>
+
+bool cube_set::insert(const elem &el) {
+    if (contains(el))
+        return false;
+    return _points.insert(el).second;
+}
+
+size_t cube_set::project(const elem &el) const {
+    size_t code{ 0 };
+    for (size_t j{ 0 }; j < _key.size(); j++)
+        if (el.test(_key[j]))
+            code |= 1ull << j;
+    return code;
+}
+
+void cube_set::file(size_t k) {
+    const auto &c = _cubes[k];
+    std::vector<size_t> free;
+    for (size_t j{ 0 }; j < _key.size(); j++)
+        if (!c.lo.test(_key[j]) && c.hi.test(_key[j]))
+            free.push_back(j);
+    if (free.size() > 4) {
+        _wide.push_back(k);
+        return;
+    }
+    // Every completion of its free key bits
+    auto base = project(c.lo);
+    for (size_t m{ 0 }; m < 1ull << free.size(); m++) {
+        auto code = base;
+        for (size_t f{ 0 }; f < free.size(); f++)
+            if (m & 1ull << f)
+                code |= 1ull << free[f];
+        _buckets[code].push_back(k);
+    }
+}
+
+void cube_set::reindex() {
+    // The bits fixed in most intervals split them best
+    auto n = _cubes.front().lo.get_size();
+    std::vector<size_t> fixed(n, 0), bits(n);
+    for (const auto &c : _cubes)
+        for (size_t i{ 0 }; i < n; i++)
+            fixed[i] += c.lo.test(i) || !c.hi.test(i);
+    for (size_t i{ 0 }; i < n; i++)
+        bits[i] = i;
+    std::stable_sort(bits.begin(), bits.end(), [&](size_t l, size_t r) { return fixed[l] > fixed[r]; });
+    bits.resize(std::min<size_t>(n, 8));
+
+    _key = std::move(bits);
+    _buckets.assign(1ull << _key.size(), {});
+    _wide.clear();
+    for (size_t k{ 0 }; k < _cubes.size(); k++)
+        file(k);
+    _keyed = _cubes.size();
+}
+
+bool cube_set::insert(const elem &lo, const elem &hi) {
+    if (!(lo <= hi) || contains(lo, hi))
+        return false;
+    if (lo == hi)
+        return insert(lo);
+
+    std::erase_if(_points, [&](const elem &el) { return lo <= el && el <= hi; });
+    auto n = _cubes.size();
+    std::erase_if(_cubes, [&](const cube &c) { return lo <= c.lo && c.hi <= hi; });
+    _cubes.push_back({ lo, hi, lo.hier(), hi.hier() });
+    // Choose the key bits again as the intervals double, or when some
+    // were dropped and the indices moved
+    if (_cubes.size() != n + 1 || _cubes.size() >= 2 * _keyed)
+        reindex();
+    else
+        file(n);
+    return true;
+}
+
+bool cube_set::contains(const elem &el) const {
+    if (_points.contains(el))
+        return true;
+    return covers(el, el);
+}
+
+bool cube_set::contains(const elem &lo, const elem &hi) const {
+    if (lo == hi)
+        return contains(lo);
+    return covers(lo, hi);
+}
+
+bool cube_set::covers(const elem &lo, const elem &hi) const {
+    if (_cubes.empty())
+        return false;
+    // Any interval holding both holds lo, so it is in the bucket of lo
+    auto hlo = lo.hier(), hhi = hi.hier();
+    auto check = [&](size_t k) {
+        const auto &c = _cubes[k];
+        return c.hlo <= hlo && hhi <= c.hhi && c.lo <= lo && hi <= c.hi;
+    };
+    const auto &b = _buckets[project(lo)];
+    return std::any_of(b.begin(), b.end(), check) || std::any_of(_wide.begin(), _wide.end(), check);
+}
+
+size_t cube_set::size() const {
+    return _points.size() + _cubes.size();
+}
+
+bool cube_set::empty() const {
+    return _points.empty() && _cubes.empty();
+}
+
+set_t::const_iterator cube_set::begin() const {
+    return _points.begin();
+}
+
+set_t::const_iterator cube_set::end() const {
+    return _points.end();
+}
+
+const std::vector<cube_set::cube> &cube_set::cubes() const {
+    return _cubes;
+}
@@ -0,0 +1,53 @@
+#ifndef LATTICE_CUBE_SET_HPP
+#define LATTICE_CUBE_SET_HPP
+
+#include <vector>
+#include "homo_set.hpp"
+
+// Union of intervals [lo, hi] = { x | lo <= x <= hi }.
+// Single elements are hashed. Wider intervals are bucketed by their values
+// on a few key bits, those fixed in most of them, so a query only scans
+// the intervals agreeing with it there (and the few leaving too many key
+// bits free), and among them only those whose levels span its level.
+class cube_set {
+public:
+    struct cube {
+        elem lo, hi;
+        size_t hlo, hhi;
+    };
+
+private:
+    set_t _points;
+    std::vector<cube> _cubes;
+
+    // Indices into _cubes, by their projection onto the bits in _key
+    std::vector<size_t> _key;
+    std::vector<std::vector<size_t>> _buckets;
+    // Those with too many key bits free to be bucketed
+    std::vector<size_t> _wide;
+    // How many _cubes there were when _key was chosen
+    size_t _keyed{ 0 };
+
+    [[nodiscard]] size_t project(const elem &el) const;
+    void file(size_t k);
+    void reindex();
+    // Whether some interval holds all of [lo, hi]
+    [[nodiscard]] bool covers(const elem &lo, const elem &hi) const;
+
+public:
+    bool insert(const elem &el);
+    // Also drops whatever it covers
+    bool insert(const elem &lo, const elem &hi);
+
+    [[nodiscard]] bool contains(const elem &el) const;
+    [[nodiscard]] bool contains(const elem &lo, const elem &hi) const;
+
+    // Elements and intervals together
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] set_t::const_iterator begin() const;
+    [[nodiscard]] set_t::const_iterator end() const;
+    [[nodiscard]] const std::vector<cube> &cubes() const;
+};
+
+#endif //LATTICE_CUBE_SET_HPP
@@ -1,12 +1,81 @@
 #include "elem.hpp"
 #include <bit>
+#include <cstring>
+#include <istream>
+#include <ostream>
 #include <algorithm>
 #include "homo_set.hpp"
 #include "util.hpp"
 
+static_assert(std::endian::native == std::endian::little);
+
+namespace {
+
+// Reverse the bits within each nibble
+uint64_t rev4(uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    return x;
+}
+
+// Bytes 0..3 of x to the even bytes
+uint64_t spread(uint64_t x) {
+    x &= 0xffffffffull;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+    return x;
+}
+
+// The even bytes of x to bytes 0..3
+uint64_t gather(uint64_t x) {
+    x &= 0x00ff00ff00ff00ffull;
+    x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+    x = (x | (x >> 16)) & 0xffffffffull;
+    return x;
+}
+
+// 64 bits to 16 hex digits and back, 8 at a time
+void put_hex(char *p, uint64_t w) {
+    w = rev4(w);
+    auto asc = [](uint64_t v) {
+        return v + 0x3030303030303030ull + (((v + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull) * 39ull;
+    };
+    auto a = asc(w & 0x0f0f0f0f0f0f0f0full);
+    auto b = asc((w >> 4) & 0x0f0f0f0f0f0f0f0full);
+    uint64_t out[2]{ spread(a) | spread(b) << 8, spread(a >> 32) | spread(b >> 32) << 8 };
+    std::memcpy(p, out, 16);
+}
+
+uint64_t get_hex(const char *p) {
+    uint64_t in[2];
+    std::memcpy(in, p, 16);
+    auto val = [](uint64_t c) {
+        return (c & 0x0f0f0f0f0f0f0f0full) + ((c >> 6) & 0x0101010101010101ull) * 9ull;
+    };
+    auto lo = val(in[0]), hi = val(in[1]);
+    return rev4(gather(lo | lo >> 4) | gather(hi | hi >> 4) << 32);
+}
+
+}
+
+int elem::fmt() {
+    static const int i{ std::ios_base::xalloc() };
+    return i;
+}
+
 std::istream &operator>>(std::istream &is, elem &el) {
     el._v.clear();
     el._v.resize(SZ(el._n), 0ull);
+    if (is.iword(elem::fmt()) == elem::HEX) {
+        std::string s;
+        is >> s;
+        s.resize(SZ(el._n) * 16ull, '0');
+        for (size_t i{ 0 }; i < el._v.size(); i++)
+            el._v[i] = get_hex(s.data() + i * 16ull);
+        if (el._n % 64ull)
+            el._v.back() &= (1ull << el._n % 64ull) - 1ull;
+        return is;
+    }
     for (size_t i{ 0 }; i < el._n; i++) {
         auto c = is.get();
         if (c != '0' && c != '1') {
@@ -21,6 +90,13 @@ std::istream &operator>>(std::istream &is, elem &el) {
 }
 
 std::ostream &operator<<(std::ostream &os, const elem &el) {
+    if (os.iword(elem::fmt()) == elem::HEX) {
+        std::string s(el._v.size() * 16ull, '0');
+        for (size_t i{ 0 }; i < el._v.size(); i++)
+            put_hex(s.data() + i * 16ull, el._v[i]);
+        s.resize((el._n + 3ull) / 4ull);
+        return os << s;
+    }
     for (size_t i{ 0 }; i < el._n; i++) {
         auto v = el._v[i / 64ull];
         os << ((v & (1ull << (i % 64ull))) ? '1' : '0');
@@ -74,6 +150,17 @@ elem elem::operator|(const elem &b) const {
     return el;
 }
 
+elem elem::operator~() const {
+    elem el;
+    el._n = _n;
+    el._v.reserve(SZ(_n));
+    for (const auto &v : _v)
+        el._v.push_back(~v);
+    if (_n % 64ull)
+        el._v.back() &= (1ull << _n % 64ull) - 1ull;
+    return el;
+}
+
 bool elem::operator>=(const elem &b) const {
     for (const auto &[l, r]: zip(_v, b._v))
         if ((l & r) != r)
@@ -88,12 +175,12 @@ bool elem::operator<=(const elem &b) const {
     return true;
 }
 
-elem::iters<true> elem::ups() const {
-    return { *this };
+elem::iters<true> elem::ups(const constraints *cs) const {
+    return { *this, cs };
 }
 
-elem::iters<false> elem::downs() const {
-    return { *this };
+elem::iters<false> elem::downs(const constraints *cs) const {
+    return { *this, cs };
 }
 
 bool elem::operator==(const elem &b) const {
@@ -122,6 +209,67 @@ size_t elem::hier() const {
     return h;
 }
 
+bool elem::test(size_t i) const {
+    return _v[i / 64ull] & (1ull << (i % 64ull));
+}
+
+void elem::flip(size_t i) {
+    _v[i / 64ull] ^= 1ull << (i % 64ull);
+}
+
+void elem::load(const uint32_t *w) {
+    _v.clear();
+    _v.resize(SZ(_n), 0ull);
+    for (size_t i{ 0 }; i < SZ32(_n); i++)
+        _v[i / 2ull] |= static_cast<uint64_t>(w[i]) << (i % 2ull * 32ull);
+}
+
+void elem::store(uint32_t *w) const {
+    for (size_t i{ 0 }; i < SZ32(_n); i++)
+        w[i] = static_cast<uint32_t>(_v[i / 2ull] >> (i % 2ull * 32ull));
+}
+
+void elem::put(char *p) const {
+    for (size_t i{ 0 }; i < _n; i++)
+        p[i] = test(i) ? '1' : '0';
+}
+
+std::string elem::hash() const {
+    auto s = std::to_string(_n) + '-';
+    if (_n <= 16ull) {
+        s += "0b";
+        for (size_t i{ 0 }; i < _n; i++)
+            s += test(i) ? '1' : '0';
+        return s;
+    }
+    if (_n <= 16ull * 2ull)
+        return s + "0o" + radix(0, _n, 2);
+    if (_n <= 16ull * 3ull)
+        return s + "0o" + radix(0, _n, 3);
+    if (_n <= 16ull * 4ull)
+        return s + "0x" + radix(0, _n, 4);
+    s += "0t";
+    for (size_t i{ 0 }; i < _n; i += 80ull)
+        s += radix(i, std::min<size_t>(_n - i, 80ull), 5);
+    return s;
+}
+
+std::string elem::radix(size_t from, size_t len, unsigned bits) const {
+    std::string r;
+    for (auto end = from + len; end > from;) {
+        auto start = end - from >= bits ? end - bits : from;
+        unsigned d{ 0 };
+        for (auto i = start; i < end; i++)
+            d = d << 1 | test(i);
+        r += "0123456789abcdefghijklmnopqrstuv"[d];
+        end = start;
+    }
+    while (r.size() > 1 && r.back() == '0')
+        r.pop_back();
+    std::reverse(r.begin(), r.end());
+    return r;
+}
+
 size_t elem::hasher::operator()(const elem &el) const {
     size_t h{ 0 };
     for (auto v : el._v)
@@ -2,13 +2,16 @@
 #define LATTICE_ELEM_HPP
 
 #include <vector>
+#include <string>
 #include <iosfwd>
 #include <cstdint>
 
 #define SZ(N) ((N) + 63ull) / 64ull
+#define SZ32(N) ((N) + 31ull) / 32ull
 
 template <bool UD>
 class homo_set;
+class constraints;
 
 class elem {
 protected:
@@ -19,6 +22,12 @@ public:
     friend std::istream &operator>>(std::istream &is, elem &el);
     friend std::ostream &operator<<(std::ostream &os, const elem &el);
 
+    // Text form used by >> and <<, kept per stream in iword(fmt()):
+    // BIN: one '0'/'1' per bit
+    // HEX: one digit per 4 bits, the first bit being the most significant
+    enum format : long { BIN, HEX };
+    [[nodiscard]] static int fmt();
+
     [[nodiscard]] static elem top(size_t N);
     [[nodiscard]] static elem bottom(size_t N);
 
@@ -27,6 +36,7 @@ public:
 
     [[nodiscard]] elem operator&(const elem &b) const;
     [[nodiscard]] elem operator|(const elem &b) const;
+    [[nodiscard]] elem operator~() const;
 
     [[nodiscard]] bool operator>=(const elem &b) const;
     [[nodiscard]] bool operator<=(const elem &b) const;
@@ -34,17 +44,21 @@ public:
     [[nodiscard]] bool operator==(const elem &b) const;
     [[nodiscard]] bool operator!=(const elem &b) const;
 
+    // Neighbors of el, only the valid ones if cs is given
     template <bool UD>
     class iters {
         const elem &_el;
-        iters(const elem &el);
+        const constraints *_cs;
+        iters(const elem &el, const constraints *cs);
     public:
         friend class elem;
 
         class iter {
             const elem &_el;
+            const constraints *_cs;
             size_t _i;
-            iter(const elem &el, size_t i);
+            iter(const elem &el, const constraints *cs, size_t i);
+            [[nodiscard]] bool ok() const;
         public:
             friend class iters;
             elem operator*() const;
@@ -58,8 +72,8 @@ public:
         [[nodiscard]] iter end() const;
     };
 
-    [[nodiscard]] iters<true> ups() const;
-    [[nodiscard]] iters<false> downs() const;
+    [[nodiscard]] iters<true> ups(const constraints *cs = nullptr) const;
+    [[nodiscard]] iters<false> downs(const constraints *cs = nullptr) const;
 
     template <bool UD>
     [[nodiscard]] bool operator<=(const homo_set<UD> &s) const;
@@ -76,11 +90,27 @@ public:
     [[nodiscard]] size_t get_size() const;
 
     [[nodiscard]] size_t hier() const;
+    [[nodiscard]] bool test(size_t i) const;
+    void flip(size_t i);
+
+    // Packed little-endian 32-bit words, SZ32(N) of them
+    void load(const uint32_t *w);
+    void store(uint32_t *w) const;
+    // One '0'/'1' per bit, as << writes in BIN, N of them
+    void put(char *p) const;
+
+    // Same as parameter.hash in JS, without the program name
+    [[nodiscard]] std::string hash() const;
+    // Bits [from, from + len) as a number in base 2^bits, the first bit most significant
+    [[nodiscard]] std::string radix(size_t from, size_t len, unsigned bits) const;
 };
 
 std::istream &operator>>(std::istream &is, elem &el);
 std::ostream &operator<<(std::ostream &os, const elem &el);
 
+// Whether flipping bit i of a valid el keeps it valid, see constraints.hpp
+[[nodiscard]] bool admits(const constraints &cs, const elem &el, size_t i);
+
 template<bool UD>
 bool elem::operator<=(const homo_set<UD> &s) const {
     return s >= *this;
@@ -92,7 +122,12 @@ bool elem::operator>=(const homo_set<UD> &s) const {
 }
 
 template <bool UD>
-elem::iters<UD>::iter::iter(const elem &el, size_t i) : _el{ el }, _i{ i } { }
+elem::iters<UD>::iter::iter(const elem &el, const constraints *cs, size_t i) : _el{ el }, _cs{ cs }, _i{ i } { }
+
+template <bool UD>
+bool elem::iters<UD>::iter::ok() const {
+    return (((_el._v[_i / 64ull] & (1ull << (_i % 64ull))) != 0) ^ UD) && (!_cs || admits(*_cs, _el, _i));
+}
 
 template <bool UD>
 elem elem::iters<UD>::iter::operator*() const {
@@ -115,7 +150,7 @@ bool elem::iters<UD>::iter::operator!=(const elem::iters<UD>::iter &o) const {
 template <bool UD>
 typename elem::iters<UD>::iter &elem::iters<UD>::iter::operator++() {
     while (++_i < _el._n)
-        if (((_el._v[_i / 64ull] & (1ull << (_i % 64ull))) != 0) ^ UD)
+        if (ok())
             break;
     return *this;
 }
@@ -128,16 +163,16 @@ const typename elem::iters<UD>::iter elem::iters<UD>::iter::operator++(int) {
 }
 
 template <bool UD>
-elem::iters<UD>::iters(const elem &el) : _el{ el } { }
+elem::iters<UD>::iters(const elem &el, const constraints *cs) : _el{ el }, _cs{ cs } { }
 
 template <bool UD>
 typename elem::iters<UD>::iter elem::iters<UD>::begin() const {
-    auto it = iter{ _el, 0 };
-    return (!(_el._v.front() & 1ull) ^ UD) ? ++it : it;
+    auto it = iter{ _el, _cs, 0 };
+    return it.ok() ? it : ++it;
 }
 
 template <bool UD>
-typename elem::iters<UD>::iter elem::iters<UD>::end() const { return { _el, _el._n }; }
+typename elem::iters<UD>::iter elem::iters<UD>::end() const { return { _el, _cs, _el._n }; }
 
 
 #endif //LATTICE_ELEM_HPP
@@ -0,0 +1,74 @@
+#include "enumerator.hpp"
+#include <bit>
+#include <algorithm>
+
+enumerator::enumerator(size_t N, order_t order, uint64_t k, uint64_t m)
+        : _n{ N }, _order{ order }, _begin{ 0 }, _end{ 0 }, _pos{ 0 }, _binom{} {
+    if (N > max_size || k >= m)
+        return;
+    uint64_t total = 1ull << N;
+    _begin = total / m * k + std::min(k, total % m);
+    _end = _begin + total / m + (k < total % m);
+    for (size_t i{ 0 }; i < 64; i++) {
+        _binom[i][0] = 1;
+        for (size_t j{ 1 }; j <= i; j++)
+            _binom[i][j] = _binom[i - 1][j - 1] + (j < i ? _binom[i - 1][j] : 0);
+    }
+}
+
+uint64_t enumerator::size() const {
+    return _end - _begin;
+}
+
+uint64_t enumerator::get_pos() const {
+    return _pos;
+}
+
+void enumerator::seek(uint64_t pos) {
+    _pos = std::min(pos, size());
+}
+
+uint64_t enumerator::at(uint64_t ord) const {
+    if (_order == GRAY)
+        return ord ^ (ord >> 1ull);
+
+    size_t h{ 0 };
+    while (ord >= _binom[_n][h])
+        ord -= _binom[_n][h++];
+    // Unrank the ord-th smallest value with h bits set
+    uint64_t v{ 0 };
+    for (auto i = _n; i-- && h;)
+        if (ord >= _binom[i][h])
+            ord -= _binom[i][h], v |= 1ull << i, h--;
+    return v;
+}
+
+elem enumerator::make(uint64_t v) const {
+    auto e = elem::bottom(_n);
+    uint32_t w[2]{ static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32ull) };
+    e.load(w);
+    return e;
+}
+
+std::vector<elem> enumerator::next(size_t batch) {
+    std::vector<elem> res;
+    if (_pos >= size())
+        return res;
+    auto v = at(_begin + _pos);
+    for (; res.size() < batch && _pos < size(); _pos++) {
+        res.push_back(make(v));
+        auto ord = _begin + _pos + 1;
+        if (_order == GRAY) {
+            v ^= 1ull << std::countr_zero(ord);
+        } else if (!v) {
+            v = 1ull;
+        } else {
+            // Gosper's hack, moving to the next level when the current one is exhausted
+            auto c = v & -v;
+            auto r = v + c;
+            auto n = (((r ^ v) >> 2ull) / c) | r;
+            v = n >> _n ? (1ull << (std::popcount(v) + 1)) - 1 : n;
+        }
+    }
+    return res;
+}
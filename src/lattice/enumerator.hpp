@@ -0,0 +1,46 @@
+#ifndef LATTICE_ENUMERATOR_HPP
+#define LATTICE_ENUMERATOR_HPP
+
+#include <vector>
+#include <array>
+#include "elem.hpp"
+
+// Brute-force walk over all 2^N elements in fixed-size batches, without
+// materializing the space. Supports N <= max_size only; callers must refuse
+// anything larger, for which the walk would be empty.
+// Positions are ordinals within the shard, so a walk can be resumed by
+// seeking to a previously saved position.
+class enumerator {
+public:
+    static constexpr size_t max_size{ 63 };
+
+    enum order_t {
+        // Reflected Gray code: successive elements differ by one bit
+        GRAY,
+        // By hier(), then by numeric value
+        LEVEL,
+    };
+
+private:
+    size_t _n;
+    order_t _order;
+    // Global ordinals of the shard: [_begin, _end)
+    uint64_t _begin, _end;
+    uint64_t _pos;
+    std::array<std::array<uint64_t, 64>, 64> _binom;
+
+    [[nodiscard]] uint64_t at(uint64_t ord) const;
+    [[nodiscard]] elem make(uint64_t v) const;
+
+public:
+    // Shard k of m, in contiguous ranges of ordinals
+    enumerator(size_t N, order_t order, uint64_t k, uint64_t m);
+
+    [[nodiscard]] uint64_t size() const;
+    [[nodiscard]] uint64_t get_pos() const;
+    void seek(uint64_t pos);
+
+    std::vector<elem> next(size_t batch);
+};
+
+#endif //LATTICE_ENUMERATOR_HPP
@@ -0,0 +1,18 @@
+#include "journal.hpp"
+#include <algorithm>
+
+void journal::add(kind k, const elem &el) {
+    _log.push_back({ k, true, el });
+}
+
+void journal::remove(kind k, const elem &el) {
+    _log.push_back({ k, false, el });
+}
+
+size_t journal::version() const {
+    return _log.size();
+}
+
+std::span<const journal::entry> journal::since(size_t v) const {
+    return std::span{ _log }.subspan(std::min(v, _log.size()));
+}
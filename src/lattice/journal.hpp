@@ -0,0 +1,35 @@
+#ifndef LATTICE_JOURNAL_HPP
+#define LATTICE_JOURNAL_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include "elem.hpp"
+
+// Additions to and removals from the listed sets, in order; the version
+// is the number of entries so far, so a client only needs what follows
+// the last version it has seen instead of whole lists every time;
+// a REGIONS change is two consecutive entries, its lower end then its upper
+class journal {
+public:
+    enum kind : uint8_t { TRUES, SUPREMA, IMPROBABLES, INFIMA, FALSES, RUNNING, REGIONS };
+    static constexpr const char *names[]{ "true", "suprema", "improbable", "infima", "false", "running", "region" };
+
+    struct entry {
+        kind k;
+        bool add;
+        elem el;
+    };
+
+private:
+    std::vector<entry> _log;
+
+public:
+    void add(kind k, const elem &el);
+    void remove(kind k, const elem &el);
+
+    [[nodiscard]] size_t version() const;
+    [[nodiscard]] std::span<const entry> since(size_t v) const;
+};
+
+#endif //LATTICE_JOURNAL_HPP
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <string>
-#include "tri_set.hpp"
+#include <unordered_map>
+#include "session.hpp"
+#include "enumerator.hpp"
 
 template <bool UD>
 auto &operator<<(std::ostream &os, const homo_set<UD> &s) {
@@ -15,93 +17,234 @@ auto &operator<<(std::ostream &os, const set_t &s) {
     return os;
 }
 
+auto &operator<<(std::ostream &os, const cube_set &s) {
+    for (const auto &e : s)
+        os << e << std::endl;
+    return os;
+}
+
+auto &operator<<(std::ostream &os, const running_set &s) {
+    for (const auto &e : s)
+        os << e << std::endl;
+    return os;
+}
+
 #ifndef EMSCRIPTEN
 
+#include <sstream>
+#include "server.hpp"
+
+// Optional execution duration following an element, on the same line
+double get_cost(std::istream &is) {
+    std::string rest;
+    std::getline(is, rest);
+    char *end;
+    auto t = std::strtod(rest.c_str(), &end);
+    return end == rest.c_str() ? -1.0 : t;
+}
+
+// Everything the commands act on, shared by all clients when serving
+struct state {
+    size_t N;
+    // Commands prefixed by "@<id> " go to session <id>, others to session ""
+    std::unordered_map<std::string, session> sessions;
+    std::unordered_map<std::string, enumerator> enums;
+};
+
+std::string strip_id(std::string &line) {
+    std::string id;
+    if (line.starts_with('@')) {
+        auto sp = line.find(' ');
+        id = line.substr(1, sp == std::string::npos ? sp : sp - 1);
+        line = sp == std::string::npos ? "" : line.substr(sp + 1);
+    }
+    return id;
+}
+
+// Lines taken by the command starting with the given one
+size_t arity(std::string line) {
+    strip_id(line);
+    if (line.starts_with("seed ")) {
+        std::istringstream ls{ line.substr(5) };
+        size_t nt{ 0 }, nf{ 0 }, nz{ 0 };
+        ls >> nt >> nf >> nz;
+        return 1 + nt + nf + nz;
+    }
+    return line == "true" || line == "false" || line == "improbable" || line == "region" || line == "hash" ? 2 : 1;
+}
+
+// Read one command from is and answer it on os
+void handle(state &st, std::istream &is, std::ostream &os) {
+    char *end;
+    std::string line;
+    std::getline(is >> std::ws, line);
+    auto id = strip_id(line);
+
+    if (line.starts_with("open ")) {
+        st.sessions.insert_or_assign(id, session{ std::strtoull(line.c_str() + 5, &end, 10) });
+        os << std::endl;
+        return;
+    } else if (line == "close") {
+        st.sessions.erase(id);
+        os << std::endl;
+        return;
+    }
+
+    auto &ss = st.sessions.try_emplace(id, st.N).first->second;
+    is.iword(elem::fmt()) = os.iword(elem::fmt()) = ss.get_format();
+    if (line == "format hex" || line == "format bin") {
+        ss.set_format(line == "format hex" ? elem::HEX : elem::BIN);
+        os << std::endl;
+    } else if (line == "hash") {
+        auto e = ss.make();
+        is >> e;
+        os << e.hash() << std::endl;
+    } else if (line == "true") {
+        auto e = ss.make();
+        is >> e;
+        os << ss.mark_true(e, get_cost(is)) << std::endl;
+    } else if (line == "false") {
+        auto e = ss.make();
+        is >> e;
+        os << ss.mark_false(e, get_cost(is)) << std::endl;
+    } else if (line == "improbable") {
+        auto e = ss.make();
+        is >> e;
+        os << ss.mark_improbable(e, get_cost(is)) << std::endl;
+    } else if (line == "region") {
+        auto lo = ss.make(), hi = ss.make();
+        is >> lo >> hi;
+        os << ss.mark_improbable(lo, hi) << std::endl;
+    } else if (line.starts_with("seed ")) {
+        // Followed by that many TRUE, FALSE, and IMPROBABLE elements
+        std::istringstream ls{ line.substr(5) };
+        size_t nt{ 0 }, nf{ 0 }, nz{ 0 };
+        ls >> nt >> nf >> nz;
+        std::vector<elem> ts(nt, ss.make()), fs(nf, ss.make()), zs(nz, ss.make());
+        for (auto *v : { &ts, &fs, &zs })
+            for (auto &e : *v)
+                is >> e;
+        os << ss.seed(ts, fs, zs) << std::endl;
+    } else if (line == "summary") {
+        for (auto v : ss.summary())
+            os << v << std::endl;
+    } else if (line == "list true") {
+        os << ss.get_ts().get_us() << std::endl;
+    } else if (line == "list suprema") {
+        os << ss.get_ts().get_sup() << std::endl;
+    } else if (line == "list improbable") {
+        os << ss.get_ts().get_zs() << std::endl;
+    } else if (line.starts_with("changes since ")) {
+        const auto &jr = ss.get_ts().get_journal();
+        os << jr.version() << std::endl;
+        for (const auto &en : jr.since(std::strtoull(line.c_str() + 14, &end, 10)))
+            os << (en.add ? '+' : '-') << journal::names[en.k] << ' ' << en.el << std::endl;
+        os << std::endl;
+    } else if (line == "list regions") {
+        for (const auto &c : ss.get_ts().get_zs().cubes())
+            os << c.lo << ' ' << c.hi << std::endl;
+        os << std::endl;
+    } else if (line == "list infima") {
+        os << ss.get_ts().get_inf() << std::endl;
+    } else if (line == "list false") {
+        os << ss.get_ts().get_ds() << std::endl;
+    } else if (line == "list disputed") {
+        os << ss.get_ts().get_disputed() << std::endl;
+    } else if (line == "list running") {
+        os << ss.get_running() << std::endl;
+    } else if (line == "list twins") {
+        for (const auto &c : ss.get_ts().twins())
+            for (auto i : c)
+                os << i << (i == c.back() ? '\n' : ' ');
+        os << std::endl;
+    } else if (line == "next u") {
+        if (auto e = ss.next_u())
+            os << e << std::endl;
+        else
+            os << std::endl;
+    } else if (line == "next d") {
+        if (auto e = ss.next_d())
+            os << e << std::endl;
+        else
+            os << std::endl;
+    } else if (line.starts_with("lease ")) {
+        std::istringstream ls{ line.substr(6) };
+        std::string dir;
+        double ms{ 0.0 };
+        ls >> dir >> ms;
+        if (auto e = ss.lease(dir == "u", ms))
+            os << e << std::endl;
+        else
+            os << std::endl;
+    } else if (line == "cancelled") {
+        for (const auto &e : ss.cancelled())
+            os << e << std::endl;
+        os << std::endl;
+    } else if (line == "finalize") {
+        ss.finalize();
+        os << std::endl;
+    } else if (line == "dualize") {
+        ss.dualize();
+        os << std::endl;
+    } else if (line.starts_with("quorum ")) {
+        ss.set_quorum(std::strtoull(line.c_str() + 7, &end, 10));
+        os << std::endl;
+    } else if (line.starts_with("require ") || line.starts_with("exclude ")) {
+        std::istringstream ls{ line.substr(8) };
+        size_t i{ 0 }, j{ 0 };
+        ls >> i >> j;
+        os << (line[0] == 'r' ? ss.require(i, j) : ss.exclude(i, j)) << std::endl;
+    } else if (line.starts_with("same ")) {
+        std::istringstream ls{ line.substr(5) };
+        size_t i{ 0 }, j{ 0 };
+        ls >> i >> j;
+        os << ss.merge(i, j) << std::endl;
+    } else if (line.starts_with("enumerate ")) {
+        std::istringstream ls{ line.substr(10) };
+        std::string order;
+        uint64_t k{ 0 }, m{ 1 };
+        ls >> order >> k >> m;
+        if (ss.get_size() > enumerator::max_size) {
+            std::cerr << "lattice: cannot enumerate " << ss.get_size() << " > "
+                      << enumerator::max_size << " bits" << std::endl;
+            os << std::endl;
+            return;
+        }
+        auto o = order == "level" ? enumerator::LEVEL : enumerator::GRAY;
+        auto &en = st.enums.insert_or_assign(id, enumerator{ ss.get_size(), o, k, m }).first->second;
+        os << en.size() << std::endl;
+    } else if (line.starts_with("seek ")) {
+        if (auto it = st.enums.find(id); it != st.enums.end())
+            it->second.seek(std::strtoull(line.c_str() + 5, &end, 10));
+        os << std::endl;
+    } else if (line == "position") {
+        if (auto it = st.enums.find(id); it != st.enums.end())
+            os << it->second.get_pos();
+        os << std::endl;
+    } else if (line.starts_with("batch ")) {
+        if (auto it = st.enums.find(id); it != st.enums.end())
+            for (const auto &e : it->second.next(std::strtoull(line.c_str() + 6, &end, 10)))
+                os << e << std::endl;
+        os << std::endl;
+    }
+}
+
 int main(int argc, char **argv) {
+    char *end;
+    state st{};
+    if (argc >= 4 && argc <= 5 && argv[1] == std::string{ "serve" } && argv[2] == std::string{ "--socket" }) {
+        st.N = argc == 5 ? std::strtoull(argv[4], &end, 10) : 0;
+        return serve(argv[3], arity, [&](std::istream &is, std::ostream &os) { handle(st, is, os); });
+    }
     if (argc != 2) {
         std::cerr << "Usage: lattice <N>" << std::endl;
+        std::cerr << "       lattice serve --socket <path|port> [<N>]" << std::endl;
         return 2;
     }
 
-    char *end;
-    size_t N = std::strtoull(argv[1], &end, 10);
-    tri_set ts;
-    set_t running;
-
-    while (!std::cin.eof()) {
-        std::string line;
-        std::getline(std::cin >> std::ws, line);
-
-        if (line == "true") {
-            elem e;
-            e.set_size(N);
-            std::cin >> e;
-            running.erase(e);
-            std::cout << ts.mark_true(e) << std::endl;
-        } else if (line == "false") {
-            elem e;
-            e.set_size(N);
-            std::cin >> e;
-            running.erase(e);
-            std::cout << ts.mark_false(e) << std::endl;
-        } else if (line == "improbable") {
-            elem e;
-            e.set_size(N);
-            std::cin >> e;
-            running.erase(e);
-            std::cout << ts.mark_improbable(e) << std::endl;
-        } else if (line == "summary") {
-            std::cout << ts.get_us().size() << std::endl;
-            std::cout << ts.get_sup().size() << std::endl;
-            std::cout << ts.get_zs().size() << std::endl;
-            std::cout << ts.get_inf().size() << std::endl;
-            std::cout << ts.get_ds().size() << std::endl;
-            std::cout << running.size() << std::endl;
-            std::cout << ts.get_us().best_hier() << std::endl;
-            std::cout << ts.get_ds().best_hier() << std::endl;
-        } else if (line == "list true") {
-            std::cout << ts.get_us() << std::endl;
-        } else if (line == "list suprema") {
-            std::cout << ts.get_sup() << std::endl;
-        } else if (line == "list improbable") {
-            std::cout << ts.get_zs() << std::endl;
-        } else if (line == "list infima") {
-            std::cout << ts.get_inf() << std::endl;
-        } else if (line == "list false") {
-            std::cout << ts.get_ds() << std::endl;
-        } else if (line == "list running") {
-            std::cout << running << std::endl;
-        } else if (line == "next u") {
-            elem e;
-            while ((e = ts.next_u()))
-                if (running.insert(e).second)
-                    break;
-            if (e)
-                std::cout << e << std::endl;
-            else
-                std::cout << std::endl;
-        } else if (line == "next d") {
-            elem e;
-            while ((e = ts.next_d()))
-                if (running.insert(e).second)
-                    break;
-            if (e)
-                std::cout << e << std::endl;
-            else
-                std::cout << std::endl;
-        } else if (line == "cancelled") {
-            std::erase_if(running, [&ts](const elem &e){
-                auto c = ts.is_decided(e);
-                if (c)
-                    std::cout << e << std::endl;
-                return c;
-            });
-            std::cout << std::endl;
-        } else if (line == "finalize") {
-            ts.check_all();
-            std::cout << std::endl;
-        }
-    }
+    st.N = std::strtoull(argv[1], &end, 10);
+    while (!std::cin.eof())
+        handle(st, std::cin, std::cout);
 }
 
 #else
@@ -110,170 +253,273 @@ int main(int argc, char **argv) {
 #include <emscripten.h>
 #include <emscripten/bind.h>
 
-tri_set ts;
-set_t running;
+// One instance per search, exported to JS as Module.Lattice.
+// The *_raw calls take elements as packed 32-bit words and return them
+// as '0'/'1' characters back to back, for JS to decode in one go, both
+// through buffers living in the wasm heap; returned views are only
+// valid until the next call on the same instance.
+class lattice {
+    session _s;
+    std::vector<uint32_t> _in;
+    std::vector<char> _out;
+    // Per element of the last changes_raw: kind * 2 + (added ? 1 : 0)
+    std::vector<uint32_t> _tags;
+    std::array<size_t, 10> _summary;
 
-auto mark_true(std::string s) {
-    elem e;
-    e.set_size(s.length());
-    std::stringstream ss{ s };
-    ss >> e;
-    running.erase(e);
-    return ts.mark_true(e);
-};
+    [[nodiscard]] elem parse(const std::string &str) {
+        _s.set_size(str.length());
+        auto e = _s.make();
+        std::stringstream ss{ str };
+        ss >> e;
+        return e;
+    }
 
-auto mark_false(std::string s) {
-    elem e;
-    e.set_size(s.length());
-    std::stringstream ss{ s };
-    ss >> e;
-    running.erase(e);
-    return ts.mark_false(e);
-};
+    template <typename Container>
+    [[nodiscard]] static std::vector<std::string> to_strings(const Container &c) {
+        std::vector<std::string> res;
+        for (const elem &el : c) {
+            std::stringstream ss;
+            ss << el;
+            res.push_back(ss.str());
+        }
+        return res;
+    }
 
-auto mark_improbable(std::string s) {
-    elem e;
-    e.set_size(s.length());
-    std::stringstream ss{ s };
-    ss >> e;
-    running.erase(e);
-    return ts.mark_improbable(e);
-};
+    [[nodiscard]] elem unpack() const {
+        auto e = _s.make();
+        e.load(_in.data());
+        return e;
+    }
 
-std::vector<size_t> summary() {
-    return {
-            ts.get_us().size(),
-            ts.get_sup().size(),
-            ts.get_zs().size(),
-            ts.get_inf().size(),
-            ts.get_ds().size(),
-            running.size(),
-            ts.get_us().best_hier(),
-            ts.get_ds().best_hier(),
-    };
-}
+    template <typename Container>
+    [[nodiscard]] emscripten::val pack(const Container &c) {
+        // Sized by what iterating yields: a cube_set also counts its intervals
+        auto n = _s.get_size();
+        _out.clear();
+        for (const elem &el : c) {
+            _out.resize(_out.size() + n);
+            el.put(_out.data() + _out.size() - n);
+        }
+        return emscripten::val{ emscripten::typed_memory_view(_out.size(), _out.data()) };
+    }
 
-auto list_true() {
-    std::vector<std::string> res;
-    for (const auto &el : ts.get_us()) {
+    [[nodiscard]] static std::string to_string(const elem &e) {
+        if (!e)
+            return {};
         std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+        ss << e;
+        return ss.str();
     }
-    return res;
-}
 
-auto list_suprema() {
-    std::vector<std::string> res;
-    for (const auto &el : ts.get_sup()) {
-        std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+public:
+    explicit lattice(size_t N) : _s{ N } { }
+
+    bool mark_true(std::string s, double t) { return _s.mark_true(parse(s), t); }
+    bool mark_false(std::string s, double t) { return _s.mark_false(parse(s), t); }
+    bool mark_improbable(std::string s, double t) { return _s.mark_improbable(parse(s), t); }
+    bool mark_region(std::string lo, std::string hi) { return _s.mark_improbable(parse(lo), parse(hi)); }
+    // Newline-separated elements
+    size_t seed(std::string ts, std::string fs, std::string zs) {
+        std::array<std::vector<elem>, 3> v;
+        for (auto k : { 0, 1, 2 }) {
+            std::istringstream is{ k == 0 ? ts : k == 1 ? fs : zs };
+            std::string line;
+            while (std::getline(is, line))
+                if (!line.empty())
+                    v[k].push_back(parse(line));
+        }
+        return _s.seed(v[0], v[1], v[2]);
     }
-    return res;
-}
 
-auto list_improbable() {
-    std::vector<std::string> res;
-    for (const auto &el : ts.get_zs()) {
-        std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+    std::vector<size_t> summary() const {
+        auto s = _s.summary();
+        return { s.begin(), s.end() };
     }
-    return res;
-}
 
-auto list_infima() {
-    std::vector<std::string> res;
-    for (const auto &el : ts.get_inf()) {
-        std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+    auto list_true() const { return to_strings(_s.get_ts().get_us()); }
+    auto list_suprema() const { return to_strings(_s.get_ts().get_sup()); }
+    auto list_improbable() const { return to_strings(_s.get_ts().get_zs()); }
+    auto list_infima() const { return to_strings(_s.get_ts().get_inf()); }
+    auto list_regions() const {
+        std::vector<std::string> res;
+        for (const auto &c : _s.get_ts().get_zs().cubes())
+            res.push_back(to_string(c.lo) + ' ' + to_string(c.hi));
+        return res;
+    }
+    auto list_false() const { return to_strings(_s.get_ts().get_ds()); }
+    auto list_running() const { return to_strings(_s.get_running()); }
+    auto list_disputed() const { return to_strings(_s.get_ts().get_disputed()); }
+    auto list_twins() const {
+        std::vector<std::string> res;
+        for (const auto &c : _s.get_ts().twins()) {
+            std::stringstream ss;
+            for (auto i : c)
+                ss << (i == c.front() ? "" : " ") << i;
+            res.push_back(ss.str());
+        }
+        return res;
     }
-    return res;
-}
 
-auto list_false() {
-    std::vector<std::string> res;
-    for (const auto &el : ts.get_ds()) {
-        std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+    std::string next_u() { return to_string(_s.next_u()); }
+    std::string next_d() { return to_string(_s.next_d()); }
+    auto cancelled() { return to_strings(_s.cancelled()); }
+
+    void finalize() { _s.finalize(); }
+    void dualize() { _s.dualize(); }
+    void quorum(size_t q) { _s.set_quorum(q); }
+    bool require(size_t i, size_t j) { return _s.require(i, j); }
+    bool exclude(size_t i, size_t j) { return _s.exclude(i, j); }
+    bool same(size_t i, size_t j) { return _s.merge(i, j); }
+
+    std::string hash(std::string s) { return parse(s).hash(); }
+
+    auto inbox(size_t n) {
+        _s.set_size(n);
+        _in.assign(SZ32(n), 0u);
+        return emscripten::val{ emscripten::typed_memory_view(_in.size(), _in.data()) };
     }
-    return res;
-}
 
-auto list_running() {
-    std::vector<std::string> res;
-    for (const auto &el : running) {
-        std::stringstream ss;
-        ss << el;
-        res.push_back(ss.str());
+    bool mark_true_raw(double t) { return _s.mark_true(unpack(), t); }
+    bool mark_false_raw(double t) { return _s.mark_false(unpack(), t); }
+    bool mark_improbable_raw(double t) { return _s.mark_improbable(unpack(), t); }
+
+    size_t version() const { return _s.get_ts().get_journal().version(); }
+
+    auto changes_raw(size_t v) {
+        auto en = _s.get_ts().get_journal().since(v);
+        auto n = _s.get_size();
+        _tags.resize(en.size());
+        _out.resize(en.size() * n);
+        for (size_t i{ 0 }; i < en.size(); i++) {
+            _tags[i] = en[i].k * 2u + en[i].add;
+            en[i].el.put(_out.data() + i * n);
+        }
+        return emscripten::val{ emscripten::typed_memory_view(_out.size(), _out.data()) };
     }
-    return res;
-}
 
-std::string next_u() {
-    elem e;
-    while ((e = ts.next_u()))
-        if (running.insert(e).second)
-            break;
-    if (!e)
-        return {};
-
-    std::stringstream ss;
-    ss << e;
-    return ss.str();
-}
+    auto changes_tags() {
+        return emscripten::val{ emscripten::typed_memory_view(_tags.size(), _tags.data()) };
+    }
 
-std::string next_d() {
-    elem e;
-    while ((e = ts.next_d()))
-        if (running.insert(e).second)
-            break;
-    if (!e)
-        return {};
-
-    std::stringstream ss;
-    ss << e;
-    return ss.str();
-}
+    auto summary_raw() {
+        _summary = _s.summary();
+        return emscripten::val{ emscripten::typed_memory_view(_summary.size(), _summary.data()) };
+    }
+
+    auto list_true_raw() { return pack(_s.get_ts().get_us()); }
+    auto list_suprema_raw() { return pack(_s.get_ts().get_sup()); }
+    auto list_improbable_raw() { return pack(_s.get_ts().get_zs()); }
+    auto list_infima_raw() { return pack(_s.get_ts().get_inf()); }
+    auto list_false_raw() { return pack(_s.get_ts().get_ds()); }
+    auto list_running_raw() { return pack(_s.get_running()); }
+
+    auto next_u_raw() {
+        auto e = _s.next_u();
+        return e ? pack(std::array{ e }) : pack(std::array<elem, 0>{});
+    }
+
+    auto next_d_raw() {
+        auto e = _s.next_d();
+        return e ? pack(std::array{ e }) : pack(std::array<elem, 0>{});
+    }
 
-auto cancelled() {
-    std::vector<std::string> res;
-    std::erase_if(running, [&res](const elem &e){
-        auto c = ts.is_decided(e);
-        if (c) {
+    auto cancelled_raw() { return pack(_s.cancelled()); }
+    std::string hash_raw() const { return unpack().hash(); }
+};
+
+// Streaming brute-force walk for -F, exported to JS as Module.Enumerator.
+// Positions are passed as doubles to avoid BigInt, so they are only exact
+// for N <= 53; JS refuses anything larger before getting here.
+class enumeration {
+    size_t _n;
+    enumerator _e;
+    std::vector<char> _out;
+
+public:
+    enumeration(size_t N, bool level, double k, double m)
+        : _n{ N }, _e{ N, level ? enumerator::LEVEL : enumerator::GRAY,
+                     static_cast<uint64_t>(k), static_cast<uint64_t>(m) } { }
+
+    double size() const { return _e.size(); }
+    double position() const { return _e.get_pos(); }
+    void seek(double pos) { _e.seek(static_cast<uint64_t>(pos)); }
+
+    std::vector<std::string> batch(size_t n) {
+        std::vector<std::string> res;
+        for (const auto &el : _e.next(n)) {
             std::stringstream ss;
-            ss << c;
+            ss << el;
             res.push_back(ss.str());
         }
-        return c;
-    });
-    return res;
-}
+        return res;
+    }
 
-void finalize() {
-    ts.check_all();
-}
+    auto batch_raw(size_t n) {
+        auto els = _e.next(n);
+        _out.resize(els.size() * _n);
+        auto p = _out.data();
+        for (const auto &el : els)
+            el.put(p), p += _n;
+        return emscripten::val{ emscripten::typed_memory_view(_out.size(), _out.data()) };
+    }
+};
 
 EMSCRIPTEN_BINDINGS(lattice) {
     using namespace emscripten;
 
-    function("mark_true", &mark_true);
-    function("mark_false", &mark_false);
-    function("mark_improbable", &mark_improbable);
-    function("summary", &summary);
-    function("list_true", &list_true);
-    function("list_suprema", &list_suprema);
-    function("list_improbable", &list_improbable);
-    function("list_infima", &list_infima);
-    function("list_false", &list_false);
-    function("list_running", &list_running);
-    function("next_u", &next_u);
-    function("next_d", &next_d);
-    function("cancelled", &cancelled);
-    function("finalize", &finalize);
+    class_<lattice>("Lattice")
+        .constructor<size_t>()
+        .function("mark_true", &lattice::mark_true)
+        .function("mark_false", &lattice::mark_false)
+        .function("mark_improbable", &lattice::mark_improbable)
+        .function("mark_region", &lattice::mark_region)
+        .function("seed", &lattice::seed)
+        .function("summary", &lattice::summary)
+        .function("list_true", &lattice::list_true)
+        .function("list_suprema", &lattice::list_suprema)
+        .function("list_improbable", &lattice::list_improbable)
+        .function("list_infima", &lattice::list_infima)
+        .function("list_regions", &lattice::list_regions)
+        .function("version", &lattice::version)
+        .function("changes_raw", &lattice::changes_raw)
+        .function("changes_tags", &lattice::changes_tags)
+        .function("list_false", &lattice::list_false)
+        .function("list_running", &lattice::list_running)
+        .function("list_disputed", &lattice::list_disputed)
+        .function("list_twins", &lattice::list_twins)
+        .function("next_u", &lattice::next_u)
+        .function("next_d", &lattice::next_d)
+        .function("cancelled", &lattice::cancelled)
+        .function("finalize", &lattice::finalize)
+        .function("dualize", &lattice::dualize)
+        .function("quorum", &lattice::quorum)
+        .function("require", &lattice::require)
+        .function("exclude", &lattice::exclude)
+        .function("same", &lattice::same)
+        .function("hash", &lattice::hash)
+        .function("inbox", &lattice::inbox)
+        .function("mark_true_raw", &lattice::mark_true_raw)
+        .function("mark_false_raw", &lattice::mark_false_raw)
+        .function("mark_improbable_raw", &lattice::mark_improbable_raw)
+        .function("summary_raw", &lattice::summary_raw)
+        .function("list_true_raw", &lattice::list_true_raw)
+        .function("list_suprema_raw", &lattice::list_suprema_raw)
+        .function("list_improbable_raw", &lattice::list_improbable_raw)
+        .function("list_infima_raw", &lattice::list_infima_raw)
+        .function("list_false_raw", &lattice::list_false_raw)
+        .function("list_running_raw", &lattice::list_running_raw)
+        .function("next_u_raw", &lattice::next_u_raw)
+        .function("next_d_raw", &lattice::next_d_raw)
+        .function("cancelled_raw", &lattice::cancelled_raw)
+        .function("hash_raw", &lattice::hash_raw);
+
+    class_<enumeration>("Enumerator")
+        .constructor<size_t, bool, double, double>()
+        .function("size", &enumeration::size)
+        .function("position", &enumeration::position)
+        .function("seek", &enumeration::seek)
+        .function("batch", &enumeration::batch)
+        .function("batch_raw", &enumeration::batch_raw);
 
     register_vector<size_t>("vector<size_t>");
     register_vector<std::string>("vector<string>");
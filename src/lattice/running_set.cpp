@@ -0,0 +1,86 @@
+#include "running_set.hpp"
+#include <bit>
+
+bool running_set::insert(const elem &el) {
+    if (!_ids.try_emplace(el, _elems.size()).second)
+        return false;
+    auto k = _elems.size();
+    _elems.push_back(el);
+    _cols.resize(el.get_size());
+    for (size_t i{ 0 }; i < _cols.size(); i++) {
+        auto &col = _cols[i];
+        col.resize(SZ(_elems.size()), 0ull);
+        if (el.test(i))
+            col[k / 64ull] |= 1ull << (k % 64ull);
+        else
+            col[k / 64ull] &= ~(1ull << (k % 64ull));
+    }
+    return true;
+}
+
+void running_set::remove_at(size_t k) {
+    auto l = _elems.size() - 1;
+    _ids.erase(_elems[k]);
+    if (k != l) {
+        for (auto &col : _cols) {
+            auto b = col[l / 64ull] & (1ull << (l % 64ull));
+            if (b)
+                col[k / 64ull] |= 1ull << (k % 64ull);
+            else
+                col[k / 64ull] &= ~(1ull << (k % 64ull));
+        }
+        _elems[k] = std::move(_elems[l]);
+        _ids[_elems[k]] = k;
+    }
+    _elems.pop_back();
+}
+
+bool running_set::erase(const elem &el) {
+    auto it = _ids.find(el);
+    if (it == _ids.end())
+        return false;
+    remove_at(it->second);
+    return true;
+}
+
+size_t running_set::size() const {
+    return _elems.size();
+}
+
+std::vector<elem>::const_iterator running_set::begin() const {
+    return _elems.begin();
+}
+
+std::vector<elem>::const_iterator running_set::end() const {
+    return _elems.end();
+}
+
+template <bool UD>
+std::vector<elem> running_set::take(const elem &el) {
+    std::vector<elem> res;
+    if (_elems.empty())
+        return res;
+    std::vector<uint64_t> mask(SZ(_elems.size()), ~0ull);
+    for (size_t i{ 0 }; i < _cols.size(); i++)
+        if (el.test(i) == UD)
+            for (size_t j{ 0 }; j < mask.size(); j++)
+                mask[j] &= UD ? _cols[i][j] : ~_cols[i][j];
+    // Backwards, so that swapping the last element in never moves a match
+    for (auto j = mask.size(); j--;)
+        for (auto m = mask[j]; m; m &= ~(1ull << (63 - std::countl_zero(m)))) {
+            auto k = j * 64ull + 63 - std::countl_zero(m);
+            if (k >= _elems.size())
+                continue;
+            res.push_back(_elems[k]);
+            remove_at(k);
+        }
+    return res;
+}
+
+std::vector<elem> running_set::take_above(const elem &el) {
+    return take<true>(el);
+}
+
+std::vector<elem> running_set::take_below(const elem &el) {
+    return take<false>(el);
+}
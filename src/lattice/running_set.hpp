@@ -0,0 +1,34 @@
+#ifndef LATTICE_RUNNING_SET_HPP
+#define LATTICE_RUNNING_SET_HPP
+
+#include <vector>
+#include <unordered_map>
+#include "elem.hpp"
+
+// Elements in flight, bit-sliced so that everything above / below
+// a newly decided element can be found without touching each of them
+class running_set {
+    std::vector<elem> _elems;
+    std::unordered_map<elem, size_t, elem::hasher> _ids;
+    // Bit k of _cols[i] is set iff bit i of _elems[k] is set
+    std::vector<std::vector<uint64_t>> _cols;
+
+    void remove_at(size_t k);
+    template <bool UD>
+    std::vector<elem> take(const elem &el);
+
+public:
+    bool insert(const elem &el);
+    bool erase(const elem &el);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] std::vector<elem>::const_iterator begin() const;
+    [[nodiscard]] std::vector<elem>::const_iterator end() const;
+
+    // Remove and return all elements >= el
+    std::vector<elem> take_above(const elem &el);
+    // Remove and return all elements <= el
+    std::vector<elem> take_below(const elem &el);
+};
+
+#endif //LATTICE_RUNNING_SET_HPP
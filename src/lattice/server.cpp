@@ -0,0 +1,131 @@
+#include "server.hpp"
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+
+int listen_on(const std::string &where) {
+    int fd;
+    if (!where.empty() && std::all_of(where.begin(), where.end(), ::isdigit)) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        int one{ 1 };
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(std::stoul(where)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            return ::close(fd), -1;
+    } else {
+        sockaddr_un addr{};
+        if (where.size() >= sizeof(addr.sun_path))
+            return -1;
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, where.c_str());
+        ::unlink(where.c_str());
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            return ::close(fd), -1;
+    }
+    if (::listen(fd, SOMAXCONN) < 0)
+        return ::close(fd), -1;
+    return fd;
+}
+
+bool send_all(int fd, const std::string &s) {
+    for (size_t off{ 0 }; off < s.size();) {
+        auto n = ::send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Run every complete command in buf, leaving the incomplete rest
+bool drain(int fd, std::string &buf,
+           const std::function<size_t(const std::string &)> &arity,
+           const std::function<void(std::istream &, std::ostream &)> &handle) {
+    while (true) {
+        auto first = buf.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            buf.clear();
+            return true;
+        }
+        auto eol = buf.find('\n', first);
+        if (eol == std::string::npos)
+            break;
+        auto pos = eol;
+        for (auto n = arity(buf.substr(first, eol - first)); n > 1 && pos != std::string::npos; n--)
+            pos = buf.find('\n', pos + 1);
+        if (pos == std::string::npos)
+            break;
+
+        std::istringstream is{ buf.substr(first, pos + 1 - first) };
+        std::ostringstream os;
+        buf.erase(0, pos + 1);
+        handle(is, os);
+        if (!send_all(fd, os.str()))
+            return false;
+    }
+    return true;
+}
+
+}
+
+int serve(const std::string &where,
+          const std::function<size_t(const std::string &)> &arity,
+          const std::function<void(std::istream &, std::ostream &)> &handle) {
+    auto lfd = listen_on(where);
+    if (lfd < 0) {
+        std::perror("lattice: cannot listen");
+        return 1;
+    }
+
+    // The first entry is the listening socket
+    std::vector<pollfd> fds{ { lfd, POLLIN, 0 } };
+    std::vector<std::string> bufs{ {} };
+    while (true) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            std::perror("lattice: poll");
+            return 1;
+        }
+
+        for (size_t k{ fds.size() - 1 }; k > 0; k--) {
+            if (!fds[k].revents)
+                continue;
+            char chunk[4096];
+            auto n = ::recv(fds[k].fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                bufs[k].append(chunk, n);
+                if (drain(fds[k].fd, bufs[k], arity, handle))
+                    continue;
+            }
+            ::close(fds[k].fd);
+            fds.erase(fds.begin() + k);
+            bufs.erase(bufs.begin() + k);
+        }
+
+        if (fds.front().revents & POLLIN)
+            if (auto cfd = ::accept(lfd, nullptr, nullptr); cfd >= 0) {
+                fds.push_back({ cfd, POLLIN, 0 });
+                bufs.emplace_back();
+            }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef LATTICE_SERVER_HPP
+#define LATTICE_SERVER_HPP
+
+#include <string>
+#include <iosfwd>
+#include <functional>
+
+// Line-based protocol served to many local clients, one command at a time.
+// arity: how many lines the command starting with the given one takes
+// handle: read one command, write its answer
+// Listens on 127.0.0.1:<where> if it is a number, on a unix socket otherwise.
+// Only returns on error.
+int serve(const std::string &where,
+          const std::function<size_t(const std::string &)> &arity,
+          const std::function<void(std::istream &, std::ostream &)> &handle);
+
+#endif //LATTICE_SERVER_HPP
@@ -0,0 +1,196 @@
+#include "session.hpp"
+#include <utility>
+
+session::session(size_t N) : _n{ N } { }
+
+size_t session::get_size() const {
+    return _n;
+}
+
+void session::set_size(size_t N) {
+    _n = N;
+}
+
+elem::format session::get_format() const {
+    return _fmt;
+}
+
+void session::set_format(elem::format f) {
+    _fmt = f;
+}
+
+elem session::make() const {
+    elem e;
+    e.set_size(_n);
+    return e;
+}
+
+void session::stop(const elem &el) {
+    if (_running.erase(el))
+        _ts.get_journal().remove(journal::RUNNING, el);
+}
+
+void session::cancel(std::vector<elem> &&els) {
+    for (const auto &e : els)
+        _ts.get_journal().remove(journal::RUNNING, e);
+    if (_cancelled.empty())
+        _cancelled = std::move(els);
+    else
+        _cancelled.insert(_cancelled.end(), els.begin(), els.end());
+}
+
+void session::settle() {
+    auto [ts, fs] = _ts.applied();
+    std::vector<elem> els;
+    auto add = [&](std::vector<elem> &&v) {
+        for (auto &e : v)
+            // Re-executions of disputed results still count
+            if (_ts.is_disputed(e))
+                _running.insert(e);
+            else
+                els.push_back(std::move(e));
+    };
+    for (const auto &e : ts)
+        add(_running.take_above(e));
+    for (const auto &e : fs)
+        add(_running.take_below(e));
+    cancel(std::move(els));
+}
+
+bool session::mark_true(const elem &el, double t) {
+    stop(el);
+    _leases.erase(el);
+    _ts.mark_cost(el, t);
+    // A late or repeated result agreeing with the lattice: nothing new,
+    // and not to be learned twice; only contradicting ones are refused
+    if (!_ts.is_disputed(el) && el >= _ts.get_us())
+        return true;
+    auto res = _ts.mark_true(el);
+    settle();
+    return res;
+}
+
+bool session::mark_false(const elem &el, double t) {
+    stop(el);
+    _leases.erase(el);
+    _ts.mark_cost(el, t);
+    // A late or repeated result agreeing with the lattice: nothing new,
+    // and not to be learned twice; only contradicting ones are refused
+    if (!_ts.is_disputed(el) && el <= _ts.get_ds())
+        return true;
+    auto res = _ts.mark_false(el);
+    settle();
+    return res;
+}
+
+bool session::mark_improbable(const elem &el, double t) {
+    stop(el);
+    _leases.erase(el);
+    _ts.mark_cost(el, t);
+    return _ts.mark_improbable(el);
+}
+
+bool session::mark_improbable(const elem &lo, const elem &hi) {
+    return _ts.mark_improbable(lo, hi);
+}
+
+size_t session::seed(const std::vector<elem> &ts, const std::vector<elem> &fs, const std::vector<elem> &zs) {
+    return _ts.seed(ts, fs, zs);
+}
+
+const tri_set &session::get_ts() const {
+    return _ts;
+}
+
+const running_set &session::get_running() const {
+    return _running;
+}
+
+std::array<size_t, 10> session::summary() const {
+    return {
+            _ts.get_us().size(),
+            _ts.get_sup().size(),
+            _ts.get_zs().size(),
+            _ts.get_inf().size(),
+            _ts.get_ds().size(),
+            _running.size(),
+            _ts.get_us().best_hier(),
+            _ts.get_ds().best_hier(),
+            _ts.get_disputed().size(),
+            _ts.dual_overflow(),
+    };
+}
+
+elem session::next_u() {
+    elem e;
+    while ((e = _ts.next_u()))
+        if (_running.insert(e)) {
+            _ts.get_journal().add(journal::RUNNING, e);
+            break;
+        }
+    return e;
+}
+
+elem session::next_d() {
+    elem e;
+    while ((e = _ts.next_d()))
+        if (_running.insert(e)) {
+            _ts.get_journal().add(journal::RUNNING, e);
+            break;
+        }
+    return e;
+}
+
+void session::expire() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = _leases.begin(); it != _leases.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+        if (_running.erase(it->first)) {
+            _ts.get_journal().remove(journal::RUNNING, it->first);
+            _ts.requeue(it->first, it->second.ud);
+        }
+        it = _leases.erase(it);
+    }
+}
+
+elem session::lease(bool ud, double ms) {
+    expire();
+    auto e = ud ? next_u() : next_d();
+    if (e) {
+        auto d = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>{ ms });
+        _leases.insert_or_assign(e, lease_t{ std::chrono::steady_clock::now() + d, ud });
+    }
+    return e;
+}
+
+std::vector<elem> session::cancelled() {
+    return std::exchange(_cancelled, {});
+}
+
+void session::finalize() {
+    _ts.check_all();
+}
+
+void session::dualize() {
+    _ts.set_dualize(_n, true);
+}
+
+void session::set_quorum(size_t q) {
+    _ts.set_quorum(q);
+}
+
+bool session::require(size_t i, size_t j) {
+    return _ts.require(_n, i, j);
+}
+
+bool session::exclude(size_t i, size_t j) {
+    return _ts.exclude(_n, i, j);
+}
+
+bool session::merge(size_t i, size_t j) {
+    return _ts.merge(_n, i, j);
+}
@@ -0,0 +1,71 @@
+#ifndef LATTICE_SESSION_HPP
+#define LATTICE_SESSION_HPP
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+#include "tri_set.hpp"
+#include "running_set.hpp"
+
+// One independent search: the lattice and the configurations in flight
+class session {
+    size_t _n;
+    tri_set _ts;
+    running_set _running;
+    // Running elements decided by marks since the last cancelled()
+    std::vector<elem> _cancelled;
+
+    struct lease_t {
+        std::chrono::steady_clock::time_point deadline;
+        bool ud;
+    };
+    // Running elements handed out by lease(), until marked or expired
+    std::unordered_map<elem, lease_t, elem::hasher> _leases;
+    // How elements are read and written over the text protocol
+    elem::format _fmt{ elem::BIN };
+
+    void stop(const elem &el);
+    void cancel(std::vector<elem> &&els);
+    // Cancel whatever the marks the lattice just applied decided
+    void settle();
+    void expire();
+
+public:
+    explicit session(size_t N);
+
+    [[nodiscard]] size_t get_size() const;
+    void set_size(size_t N);
+    [[nodiscard]] elem make() const;
+    [[nodiscard]] elem::format get_format() const;
+    void set_format(elem::format f);
+
+    [[nodiscard]] bool mark_true(const elem &el, double t);
+    [[nodiscard]] bool mark_false(const elem &el, double t);
+    [[nodiscard]] bool mark_improbable(const elem &el, double t);
+    [[nodiscard]] bool mark_improbable(const elem &lo, const elem &hi);
+    // Results of an earlier search, already mapped onto this one
+    size_t seed(const std::vector<elem> &ts, const std::vector<elem> &fs, const std::vector<elem> &zs);
+
+    [[nodiscard]] const tri_set &get_ts() const;
+    [[nodiscard]] const running_set &get_running() const;
+    [[nodiscard]] std::array<size_t, 10> summary() const;
+
+    elem next_u();
+    elem next_d();
+    // Like next_u (ud) / next_d, but queued again unless marked within ms
+    elem lease(bool ud, double ms);
+    std::vector<elem> cancelled();
+
+    void finalize();
+    void dualize();
+    // Conflicting results are run again until one side has q votes
+    void set_quorum(size_t q);
+    // Parameter i needs j / cannot go with j; only before any mark
+    [[nodiscard]] bool require(size_t i, size_t j);
+    [[nodiscard]] bool exclude(size_t i, size_t j);
+    // Parameters i and j are interchangeable; only before any mark
+    [[nodiscard]] bool merge(size_t i, size_t j);
+};
+
+#endif //LATTICE_SESSION_HPP
@@ -0,0 +1,48 @@
+#include "transversals.hpp"
+
+transversals::transversals(size_t N) : _tr{ elem::bottom(N) } { }
+
+std::vector<elem> transversals::add_edge(const elem &edge) {
+    if (_tr.empty())
+        return {};
+
+    // Those disjoint from the edge have to grow by one of its vertices
+    auto rest = ~edge;
+    std::vector<elem> keep, grow, res;
+    for (auto &t : _tr)
+        (t <= rest ? grow : keep).push_back(std::move(t));
+
+    // A grown one can only be made non-minimal by a kept one
+    for (const auto &t : grow)
+        for (size_t i{ 0 }; i < edge.get_size(); i++) {
+            if (!edge.test(i))
+                continue;
+            auto x = t;
+            x.flip(i);
+            auto flag = true;
+            for (const auto &k : keep)
+                if (k <= x) {
+                    flag = false;
+                    break;
+                }
+            if (flag)
+                res.push_back(std::move(x));
+        }
+
+    if (keep.size() + res.size() > cap) {
+        _overflow = true;
+        _tr.clear();
+        return {};
+    }
+    _tr = std::move(keep);
+    _tr.insert(_tr.end(), res.begin(), res.end());
+    return res;
+}
+
+const std::vector<elem> &transversals::get() const {
+    return _tr;
+}
+
+bool transversals::overflow() const {
+    return _overflow;
+}
@@ -0,0 +1,29 @@
+#ifndef LATTICE_TRANSVERSALS_HPP
+#define LATTICE_TRANSVERSALS_HPP
+
+#include <vector>
+#include "elem.hpp"
+
+// Minimal transversals of a hypergraph that only ever gains edges,
+// maintained incrementally by Berge multiplication.
+// Gives up (and stays empty) once more than a fixed number would be kept.
+class transversals {
+    std::vector<elem> _tr;
+    bool _overflow{ false };
+
+public:
+    static constexpr size_t cap{ 16384 };
+
+    // None at all, e.g. before the size is known
+    transversals() = default;
+    // Of no edges yet: just the bottom of N bits
+    explicit transversals(size_t N);
+
+    // Add an edge and return the transversals created by it
+    std::vector<elem> add_edge(const elem &edge);
+
+    [[nodiscard]] const std::vector<elem> &get() const;
+    [[nodiscard]] bool overflow() const;
+};
+
+#endif //LATTICE_TRANSVERSALS_HPP
@@ -1,4 +1,6 @@
 #include "tri_set.hpp"
+#include <cmath>
+#include <utility>
 
 const homo_set<true> &tri_set::get_us() const {
     return _us;
@@ -8,7 +10,15 @@ const homo_set<false> &tri_set::get_ds() const {
     return _ds;
 }
 
-const set_t &tri_set::get_zs() const {
+const journal &tri_set::get_journal() const {
+    return _jr;
+}
+
+journal &tri_set::get_journal() {
+    return _jr;
+}
+
+const cube_set &tri_set::get_zs() const {
     return _zs;
 }
 
@@ -20,93 +30,512 @@ const set_t &tri_set::get_inf() const {
     return _inf;
 }
 
+void tri_set::learn(const elem &el, bool val) {
+    if (_hu.size() != _n) {
+        _hu.resize(_n, 0.0), _mu.resize(_n, 0.0);
+        _hd.resize(_n, 0.0), _md.resize(_n, 0.0);
+    }
+    auto h = el.hier();
+    for (size_t i{ 0 }; i < _n; i++)
+        if (el.test(i))
+            (val ? _hd[i] : _md[i]) += val ? 1.0 / h : 1.0;
+        else
+            (val ? _mu[i] : _hu[i]) += val ? 1.0 : 1.0 / (_n - h);
+    _ver++;
+}
+
+template <bool UD>
+double tri_set::gain(const elem &el) const {
+    // Probability of el staying on the side of where it was derived from,
+    // assuming each moved bit independently breaks it with a Laplace-smoothed rate
+    // Nothing learned yet; _ver also counts cost measurements
+    if (_hu.size() != _n)
+        return 0.0;
+    const auto &h = UD ? _hu : _hd;
+    const auto &m = UD ? _mu : _md;
+    double g{ 0.0 };
+    for (size_t i{ 0 }; i < _n; i++)
+        if (el.test(i) != UD)
+            g += std::log1p(-(h[i] + 1.0) / (h[i] + m[i] + 2.0));
+    return g;
+}
+
+double tri_set::cost(const elem &el) const {
+    if (!_cn || _ct <= 0.0)
+        return 0.0;
+    auto mh = _ch / _cn, mt = _ct / _cn;
+    auto vh = _chh / _cn - mh * mh;
+    if (vh < 1e-9)
+        return 0.0;
+    auto b = (_cht / _cn - mh * mt) / vh;
+    auto t = mt + b * (el.hier() - mh);
+    // Damped, so that cheap but far-fetched candidates do not starve the rest
+    return std::sqrt(std::max(t / mt, 1e-2));
+}
+
+void tri_set::mark_cost(const elem &el, double t) {
+    if (t < 0.0)
+        return;
+    double h = el.hier();
+    _cn += 1.0, _ch += h, _chh += h * h, _ct += t, _cht += h * t;
+    _ver++;
+}
+
+const constraints *tri_set::filter() const {
+    return _cs.empty() ? nullptr : &_cs;
+}
+
+bool tri_set::require(size_t N, size_t i, size_t j) {
+    if (!_us.empty() || !_ds.empty() || !_zs.empty())
+        return false;
+    return _cs.require(N, i, j);
+}
+
+bool tri_set::exclude(size_t N, size_t i, size_t j) {
+    if (!_us.empty() || !_ds.empty() || !_zs.empty())
+        return false;
+    return _cs.exclude(N, i, j);
+}
+
+bool tri_set::merge(size_t N, size_t i, size_t j) {
+    if (!_us.empty() || !_ds.empty() || !_zs.empty())
+        return false;
+    return _cs.merge(N, i, j);
+}
+
+void tri_set::push_u(const elem &el, int64_t bonus) {
+    if (!_cs.valid(el))
+        return;
+    _uq.emplace(el, bonus, gain<true>(el), cost(el), _ver);
+}
+
+void tri_set::push_d(const elem &el, int64_t bonus) {
+    if (!_cs.valid(el))
+        return;
+    _dq.emplace(el, bonus, gain<false>(el), cost(el), _ver);
+}
+
+void tri_set::push_xu(const elem &el) {
+    // An invalid one stands for the largest valid elements below it
+    for (const auto &e : _cs.valid(el) ? std::vector{ el } : _cs.floor(el))
+        if (!(e >= _us || e <= _ds || _zs.contains(e)))
+            _xuq.emplace(e, 0ll, gain<true>(e), cost(e), _ver);
+}
+
+void tri_set::push_xd(const elem &el) {
+    for (const auto &e : _cs.valid(el) ? std::vector{ el } : _cs.ceil(el))
+        if (!(e >= _us || e <= _ds || _zs.contains(e)))
+            _xdq.emplace(e, 0ll, gain<false>(e), cost(e), _ver);
+}
+
+void tri_set::dual_true(const elem &el) {
+    for (const auto &t : _xt.add_edge(el))
+        push_xu(~t);
+}
+
+void tri_set::dual_false(const elem &el) {
+    for (const auto &t : _xf.add_edge(~el))
+        push_xd(t);
+}
+
+void tri_set::set_dualize(size_t N, bool dual) {
+    _dual = dual;
+    if (dual) {
+        _n = N;
+        redualize();
+    }
+}
+
+bool tri_set::dual_overflow() const {
+    return _dual && (_xt.overflow() || _xf.overflow());
+}
+
 bool tri_set::check_sup(const elem &el) {
     // Note: el should be FALSE before proceed
-    for (const auto &e : el.ups())
+    for (const auto &e : el.ups(filter()))
         if (!(e >= _us || _zs.contains(e)))
             return false;
-    _sup.insert(el);
+    if (_sup.insert(el).second)
+        _jr.add(journal::SUPREMA, el);
     return true;
 }
 
 bool tri_set::check_inf(const elem &el) {
     // Note: el should be TRUE before proceed
-    for (const auto &e : el.downs())
+    for (const auto &e : el.downs(filter()))
         if (!(e <= _ds || _zs.contains(e)))
             return false;
-    _inf.insert(el);
+    if (_inf.insert(el).second)
+        _jr.add(journal::INFIMA, el);
     return true;
 }
 
-bool tri_set::mark_true(const elem &el) {
-    _n = el.get_size();
-    if (el <= _ds)
-        return false;
+void tri_set::add_true(const elem &el) {
+    if (_us <= el)
+        return;
+    for (const auto &e : _us)
+        if (e >= el)
+            _jr.remove(journal::TRUES, e);
+    _us += el;
+    _jr.add(journal::TRUES, el);
+    if (_dual)
+        dual_true(el);
+}
 
-    _ud = 0;
-    _ul.clear();
-    _dd = 0;
-    _dl.clear();
+void tri_set::add_false(const elem &el) {
+    if (_ds >= el)
+        return;
+    for (const auto &e : _ds)
+        if (e <= el)
+            _jr.remove(journal::FALSES, e);
+    _ds += el;
+    _jr.add(journal::FALSES, el);
+    if (_dual)
+        dual_false(el);
+}
 
-    _us += el;
+void tri_set::settle_true(const elem &el) {
     if (!check_inf(el)) {
         auto xa = el;
         for (const auto &e : _us) {
             auto x = el & e;
             xa &= e;
             if (!(x <= _ds) && !_zs.contains(x))
-                _uq.emplace(x, 0ll);
+                push_u(x, 0ll);
         }
         if (!(xa <= _ds) && !_zs.contains(xa))
-            _uq.emplace(xa, 0ll);
-        for (const auto &e : el.downs())
+            push_u(xa, 0ll);
+        for (const auto &e : el.downs(filter()))
             if (!(e <= _ds) && !_zs.contains(e))
-                _uq.emplace(e, 0ll);
+                push_u(e, 0ll);
     }
 
-    for (const auto &e : el.downs())
+    for (const auto &e : el.downs(filter()))
         if (_ds.contains(e))
             check_sup(e);
+}
+
+void tri_set::settle_false(const elem &el) {
+    if (!check_sup(el)) {
+        auto xa = el;
+        for (const auto &e : _ds) {
+            auto x = el | e;
+            xa |= e;
+            if (!(x >= _us) && !_zs.contains(x))
+                push_d(x, 0ll);
+        }
+        if (!(xa >= _us) && !_zs.contains(xa))
+            push_d(xa, 0ll);
+        for (const auto &e : el.ups(filter()))
+            if (!(e >= _us) && !_zs.contains(e))
+                push_d(e, 0ll);
+    }
+
+    for (const auto &e : el.ups(filter()))
+        if (_us.contains(e))
+            check_inf(e);
+}
+
+void tri_set::take_true(const elem &el) {
+    _ud = 0;
+    _ul.clear();
+    _dd = 0;
+    _dl.clear();
+
+    add_true(el);
+    learn(el, true);
+    settle_true(el);
+    _at.push_back(el);
+}
+
+void tri_set::take_false(const elem &el) {
+    _ud = 0;
+    _ul.clear();
+    _dd = 0;
+    _dl.clear();
+
+    add_false(el);
+    learn(el, false);
+    settle_false(el);
+    _af.push_back(el);
+}
+
+bool tri_set::mark_true(const elem &el) {
+    if (!_cs.valid(el)) {
+        // Move to the valid elements it implies. TRUE says nothing about
+        // those below, so with none above (e.g. the top breaking an
+        // exclusion) the largest ones it stands for are only queued
+        auto els = _cs.ceil(el);
+        if (els.empty()) {
+            _n = el.get_size();
+            for (const auto &e : _cs.floor(el))
+                push_u(e, 0ll);
+            return false;
+        }
+        auto flag = false;
+        for (const auto &e : els)
+            flag |= mark_true(e);
+        return flag;
+    }
 
+    _n = el.get_size();
+    _votes[el].t++;
+    if (_disputed.contains(el))
+        return ballot(el);
+    if (el <= _ds)
+        return _quorum > 1 && dispute(el, true);
+
+    take_true(el);
     return true;
 }
 
 bool tri_set::mark_false(const elem &el) {
+    if (!_cs.valid(el)) {
+        // The valid elements it implies
+        auto flag = false;
+        for (const auto &e : _cs.floor(el))
+            flag |= mark_false(e);
+        return flag;
+    }
+
     _n = el.get_size();
+    _votes[el].f++;
+    if (_disputed.contains(el))
+        return ballot(el);
     if (el >= _us)
+        return _quorum > 1 && dispute(el, false);
+
+    take_false(el);
+    return true;
+}
+
+void tri_set::set_quorum(size_t q) {
+    _quorum = q;
+}
+
+size_t tri_set::get_quorum() const {
+    return _quorum;
+}
+
+int tri_set::verdict(const elem &el) const {
+    auto it = _votes.find(el);
+    if (it == _votes.end())
+        return 0;
+    auto [t, f] = it->second;
+    if (t > f && t >= _quorum)
+        return 1;
+    if (f > t && f >= _quorum)
+        return -1;
+    return 0;
+}
+
+bool tri_set::dispute(const elem &el, bool val) {
+    // el only stands if every earlier result against it goes, so these
+    // and el itself are exactly what is worth running again
+    std::vector<elem> els{ el };
+    for (const auto &[e, v] : _votes)
+        if (val ? el <= e && v.f > v.t : e <= el && v.t > v.f)
+            els.push_back(e);
+    // Already settled on both sides: keep what stands, as without a quorum
+    if (std::all_of(els.begin(), els.end(), [this](const elem &e) { return verdict(e); }))
         return false;
 
+    for (const auto &e : els)
+        if (_disputed.insert(e).second && !verdict(e) && _rerun.insert(e).second)
+            _rq.push_back(e);
+    return true;
+}
+
+bool tri_set::ballot(const elem &el) {
+    if (!verdict(el)) {
+        // Once more
+        _rerun.insert(el);
+        _rq.push_back(el);
+    } else if (_rerun.erase(el) && _rerun.empty()) {
+        resolve();
+    }
+    return true;
+}
+
+void tri_set::resolve() {
+    auto els = std::exchange(_disputed, {});
+    // Take back what the losers put in place, then apply the winners;
+    // whatever still conflicts with them is disputed anew
+    for (const auto &e : els)
+        if (auto v = verdict(e); v > 0)
+            retract_false(e);
+        else if (v < 0)
+            retract_true(e);
+    for (const auto &e : els)
+        if (auto v = verdict(e); v > 0 && !(e >= _us)) {
+            if (!(e <= _ds))
+                take_true(e);
+            else
+                dispute(e, true);
+        } else if (v < 0 && !(e <= _ds)) {
+            if (!(e >= _us))
+                take_false(e);
+            else
+                dispute(e, false);
+        }
+}
+
+void tri_set::retract_true(const elem &el) {
+    if (!_us.erase(el))
+        return;
+    _jr.remove(journal::TRUES, el);
+
     _ud = 0;
     _ul.clear();
     _dd = 0;
     _dl.clear();
 
-    _ds += el;
-    if (!check_sup(el)) {
-        auto xa = el;
-        for (const auto &e : _ds) {
-            auto x = el | e;
-            xa |= e;
-            if (!(x >= _us) && !_zs.contains(x))
-                _dq.emplace(x, 0ll);
+    // What el covered and still holds on its own
+    std::vector<elem> back;
+    for (const auto &[e, v] : _votes)
+        if (v.t > v.f && el <= e && e != el && !(e <= _ds))
+            add_true(e), back.push_back(e);
+
+    for (auto it = _inf.begin(); it != _inf.end();)
+        if (!(*it >= _us)) {
+            _jr.remove(journal::INFIMA, *it);
+            it = _inf.erase(it);
+        } else {
+            ++it;
+        }
+    for (auto it = _sup.begin(); it != _sup.end();) {
+        auto flag = true;
+        for (const auto &e : it->ups(filter()))
+            if (!(e >= _us || _zs.contains(e))) {
+                flag = false;
+                break;
+            }
+        if (!flag) {
+            _jr.remove(journal::SUPREMA, *it);
+            it = _sup.erase(it);
+        } else {
+            ++it;
         }
-        if (!(xa >= _us) && !_zs.contains(xa))
-            _dq.emplace(xa, 0ll);
-        for (const auto &e : el.ups())
-            if (!(e >= _us) && !_zs.contains(e))
-                _dq.emplace(e, 0ll);
     }
+    if (_dual)
+        redualize();
 
-    for (const auto &e : el.ups())
+    for (const auto &e : back)
         if (_us.contains(e))
-            check_inf(e);
+            settle_true(e);
+}
 
-    return true;
+void tri_set::retract_false(const elem &el) {
+    if (!_ds.erase(el))
+        return;
+    _jr.remove(journal::FALSES, el);
+
+    _ud = 0;
+    _ul.clear();
+    _dd = 0;
+    _dl.clear();
+
+    // What el covered and still holds on its own
+    std::vector<elem> back;
+    for (const auto &[e, v] : _votes)
+        if (v.f > v.t && e <= el && e != el && !(e >= _us))
+            add_false(e), back.push_back(e);
+
+    for (auto it = _sup.begin(); it != _sup.end();)
+        if (!(*it <= _ds)) {
+            _jr.remove(journal::SUPREMA, *it);
+            it = _sup.erase(it);
+        } else {
+            ++it;
+        }
+    for (auto it = _inf.begin(); it != _inf.end();) {
+        auto flag = true;
+        for (const auto &e : it->downs(filter()))
+            if (!(e <= _ds || _zs.contains(e))) {
+                flag = false;
+                break;
+            }
+        if (!flag) {
+            _jr.remove(journal::INFIMA, *it);
+            it = _inf.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (_dual)
+        redualize();
+
+    for (const auto &e : back)
+        if (_ds.contains(e))
+            settle_false(e);
+}
+
+void tri_set::redualize() {
+    // Transversals only ever grow, so start over from what is left
+    _xt = transversals{ _n }, _xf = transversals{ _n };
+    for (const auto &el : _us)
+        _xt.add_edge(el);
+    for (const auto &el : _ds)
+        _xf.add_edge(~el);
+    for (const auto &t : _xt.get())
+        push_xu(~t);
+    for (const auto &t : _xf.get())
+        push_xd(t);
 }
 
 bool tri_set::mark_improbable(const elem &el) {
     _n = el.get_size();
-    if (el >= _us || el <= _ds)
+    if (el >= _us || el <= _ds || !_cs.valid(el))
+        return false;
+
+    _ud = 0;
+    _ul.clear();
+    _dd = 0;
+    _dl.clear();
+
+    if (_zs.insert(el))
+        _jr.add(journal::IMPROBABLES, el);
+    for (const auto &e : el.downs(filter()))
+        if (!(e <= _ds) && !_zs.contains(e))
+            push_u(e, -(el.get_size() - el.hier()) / 2 - 1);
+    for (const auto &e : el.ups(filter()))
+        if (!(e >= _us) && !_zs.contains(e))
+            push_d(e, -el.hier() / 2 - 1);
+
+    for (const auto &e : el.ups(filter()))
+        if (_us.contains(e))
+            check_inf(e);
+    for (const auto &e : el.downs(filter()))
+        if (_ds.contains(e))
+            check_sup(e);
+
+    coalesce(el, el);
+    return true;
+}
+
+void tri_set::coalesce(const elem &lo, const elem &hi) {
+    auto l = lo, h = hi;
+    for (auto flag = true; flag;) {
+        flag = false;
+        for (size_t i{ 0 }; i < _n; i++) {
+            if (l.test(i) != h.test(i))
+                continue;
+            auto ml = l, mh = h;
+            ml.flip(i), mh.flip(i);
+            if (_zs.contains(ml, mh))
+                l &= ml, h |= mh, flag = true;
+        }
+    }
+    if (l != lo || h != hi)
+        (void)mark_improbable(l, h);
+}
+
+bool tri_set::mark_improbable(const elem &lo, const elem &hi) {
+    if (lo == hi)
+        return mark_improbable(lo);
+    _n = lo.get_size();
+    // Both ends are in it, so neither may be decided
+    if (!(lo <= hi) || hi >= _us || lo <= _ds)
         return false;
 
     _ud = 0;
@@ -114,32 +543,111 @@ bool tri_set::mark_improbable(const elem &el) {
     _dd = 0;
     _dl.clear();
 
-    _zs.insert(el);
-    for (const auto &e : el.downs())
+    std::vector<elem> covered;
+    for (const auto &e : _zs)
+        if (lo <= e && e <= hi)
+            covered.push_back(e);
+    std::vector<cube_set::cube> swallowed;
+    for (const auto &c : _zs.cubes())
+        if (lo <= c.lo && c.hi <= hi)
+            swallowed.push_back(c);
+    if (!_zs.insert(lo, hi))
+        return false;
+    for (const auto &e : covered)
+        _jr.remove(journal::IMPROBABLES, e);
+    for (const auto &c : swallowed) {
+        _jr.remove(journal::REGIONS, c.lo);
+        _jr.remove(journal::REGIONS, c.hi);
+    }
+    _jr.add(journal::REGIONS, lo);
+    _jr.add(journal::REGIONS, hi);
+    for (const auto &e : lo.downs(filter()))
         if (!(e <= _ds) && !_zs.contains(e))
-            _uq.emplace(e, -(el.get_size() - el.hier()) / 2 - 1);
-    for (const auto &e : el.ups())
+            push_u(e, -(lo.get_size() - lo.hier()) / 2 - 1);
+    for (const auto &e : hi.ups(filter()))
         if (!(e >= _us) && !_zs.contains(e))
-            _dq.emplace(e, -el.hier() / 2 - 1);
+            push_d(e, -hi.hier() / 2 - 1);
 
-    for (const auto &e : el.ups())
+    for (const auto &e : hi.ups(filter()))
         if (_us.contains(e))
             check_inf(e);
-    for (const auto &e : el.downs())
+    for (const auto &e : lo.downs(filter()))
         if (_ds.contains(e))
             check_sup(e);
 
+    coalesce(lo, hi);
     return true;
 }
 
+size_t tri_set::seed(const std::vector<elem> &ts, const std::vector<elem> &fs, const std::vector<elem> &zs) {
+    _ud = 0;
+    _ul.clear();
+    _dd = 0;
+    _dl.clear();
+
+    // Build the antichains first, so that dominated marks cost nothing
+    size_t cnt{ 0 };
+    for (const auto &el : ts)
+        if (_cs.valid(el) && !(el <= _ds)) {
+            _n = el.get_size();
+            _votes[el].t++;
+            add_true(el);
+            learn(el, true);
+            cnt++;
+        }
+    for (const auto &el : fs)
+        if (_cs.valid(el) && !(el >= _us)) {
+            _n = el.get_size();
+            _votes[el].f++;
+            add_false(el);
+            learn(el, false);
+            cnt++;
+        }
+
+    for (const auto &el : ts)
+        if (_us.contains(el))
+            settle_true(el);
+    for (const auto &el : fs)
+        if (_ds.contains(el))
+            settle_false(el);
+    for (const auto &el : zs)
+        cnt += mark_improbable(el);
+    return cnt;
+}
+
+template <bool UD, typename Q>
+elem tri_set::pop(Q &q) {
+    while (!q.empty()) {
+        auto el = q.top();
+        q.pop();
+        if (el >= _us || el <= _ds || _zs.contains(el))
+            continue;
+        if (el.stale(_ver)) {
+            el.rescore(gain<UD>(el), cost(el), _ver);
+            if (!q.empty() && typename aelem<UD>::hier_cmp{}(el, q.top())) {
+                q.push(std::move(el));
+                continue;
+            }
+        }
+        return el;
+    }
+    return {};
+}
+
 elem tri_set::next_u() {
-    while (!_uq.empty()) {
-        auto el = _uq.top();
-        _uq.pop();
-        if (!(el >= _us || el <= _ds || _zs.contains(el)))
-            return std::move(el);
+    while (!_rq.empty()) {
+        auto el = _rq.front();
+        _rq.pop_front();
+        if (_rerun.contains(el))
+            return el;
     }
 
+    if (auto el = pop<true>(_uq))
+        return el;
+    // Dualization only fills in where the usual candidates ran out
+    if (auto el = pop<true>(_xuq))
+        return el;
+
     if (_ud > _n)
         return {};
 
@@ -147,7 +655,7 @@ elem tri_set::next_u() {
 
     set_t next;
     for (const auto &el : curr)
-        for (const elem &eu : el.ups()) {
+        for (const elem &eu : el.ups(filter())) {
             auto flag = true;
             for (const elem &e : _us)
                 if (e != el && eu >= e) {
@@ -157,9 +665,9 @@ elem tri_set::next_u() {
             if (!flag)
                 continue;
             next.insert(eu);
-            for (const elem &e : eu.downs())
-                if (!(el >= _us || el <= _ds || _zs.contains(el)))
-                    _uq.emplace(e, -_ud - 1ull);
+            for (const elem &e : eu.downs(filter()))
+                if (!(e >= _us || e <= _ds || _zs.contains(e)))
+                    push_u(e, -_ud - 1ull);
         }
 
     _ud++;
@@ -169,13 +677,19 @@ elem tri_set::next_u() {
 }
 
 elem tri_set::next_d() {
-    while (!_dq.empty()) {
-        auto el = _dq.top();
-        _dq.pop();
-        if (!(el >= _us || el <= _ds || _zs.contains(el)))
-            return std::move(el);
+    while (!_rq.empty()) {
+        auto el = _rq.front();
+        _rq.pop_front();
+        if (_rerun.contains(el))
+            return el;
     }
 
+    if (auto el = pop<false>(_dq))
+        return el;
+    // Dualization only fills in where the usual candidates ran out
+    if (auto el = pop<false>(_xdq))
+        return el;
+
     if (_dd > _n)
         return {};
 
@@ -183,7 +697,7 @@ elem tri_set::next_d() {
 
     set_t next;
     for (const auto &el : curr)
-        for (const elem &ed : el.downs()) {
+        for (const elem &ed : el.downs(filter())) {
             auto flag = true;
             for (const elem &e : _ds)
                 if (e != el && ed <= e) {
@@ -193,9 +707,9 @@ elem tri_set::next_d() {
             if (!flag)
                 continue;
             next.insert(ed);
-            for (const elem &e : ed.ups())
-                if (!(el >= _ds || el <= _ds || _zs.contains(el)))
-                    _dq.emplace(e, -_dd - 1ull);
+            for (const elem &e : ed.ups(filter()))
+                if (!(e >= _us || e <= _ds || _zs.contains(e)))
+                    push_d(e, -_dd - 1ull);
         }
 
     _dd++;
@@ -204,13 +718,84 @@ elem tri_set::next_d() {
     return next_d();
 }
 
+void tri_set::requeue(const elem &el, bool ud) {
+    if (_rerun.contains(el)) {
+        _rq.push_back(el);
+        return;
+    }
+    if (el >= _us || el <= _ds || _zs.contains(el))
+        return;
+    if (ud)
+        push_u(el, 0ll);
+    else
+        push_d(el, 0ll);
+}
+
 bool tri_set::is_decided(const elem &el) const {
     return el >= _us || el <= _ds;
 }
 
+bool tri_set::is_disputed(const elem &el) const {
+    return _disputed.contains(el);
+}
+
+const set_t &tri_set::get_disputed() const {
+    return _disputed;
+}
+
+std::pair<std::vector<elem>, std::vector<elem>> tri_set::applied() {
+    return { std::exchange(_at, {}), std::exchange(_af, {}) };
+}
+
 void tri_set::check_all() {
     for (const auto &el : _us)
         check_inf(el);
     for (const auto &el : _ds)
         check_sup(el);
 }
+
+std::vector<std::vector<size_t>> tri_set::twins() const {
+    if (_us.empty() && _ds.empty())
+        return {};
+    auto n = (_us.empty() ? *_ds.begin() : *_us.begin()).get_size();
+
+    std::vector<size_t> rep(n);
+    for (size_t i{ 0 }; i < n; i++)
+        rep[i] = i;
+    auto find = [&](size_t i) {
+        while (rep[i] != i)
+            i = rep[i];
+        return i;
+    };
+
+    for (size_t i{ 0 }; i < n; i++)
+        for (size_t j{ i + 1 }; j < n; j++) {
+            if (find(i) == find(j))
+                continue;
+            // Swapping the two must keep every mark telling them apart
+            auto seen = false, flag = true;
+            for (auto e : _us)
+                if (e.test(i) != e.test(j)) {
+                    seen = true;
+                    e.flip(i), e.flip(j);
+                    if (!(flag = e >= _us))
+                        break;
+                }
+            if (flag)
+                for (auto e : _ds)
+                    if (e.test(i) != e.test(j)) {
+                        seen = true;
+                        e.flip(i), e.flip(j);
+                        if (!(flag = e <= _ds))
+                            break;
+                    }
+            if (seen && flag)
+                rep[find(j)] = find(i);
+        }
+
+    std::vector<std::vector<size_t>> res(n);
+    for (size_t i{ 0 }; i < n; i++)
+        res[find(i)].push_back(i);
+    std::erase_if(res, [](const std::vector<size_t> &c) { return c.size() < 2; });
+    return res;
+}
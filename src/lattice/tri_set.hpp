@@ -2,26 +2,46 @@
 #define LATTICE_TRI_SET_HPP
 
 #include <queue>
+#include <deque>
 #include <unordered_set>
+#include <unordered_map>
 #include <list>
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include "homo_set.hpp"
+#include "transversals.hpp"
+#include "constraints.hpp"
+#include "cube_set.hpp"
+#include "journal.hpp"
 
 class tri_set {
     template <bool UD>
     class aelem : public elem {
         int64_t _bonus;
+        // Log-likelihood of a decisive outcome, as of model version _ver
+        double _gain;
+        // Expected execution cost relative to the average, as of model version _ver;
+        // 0 if nothing has been measured
+        double _cost;
+        size_t _ver;
     public:
-        aelem(const elem &el, int64_t bonus) : elem{ el }, _bonus{ bonus } { }
+        aelem(const elem &el, int64_t bonus, double gain, double cost, size_t ver)
+            : elem{ el }, _bonus{ bonus }, _gain{ gain }, _cost{ cost }, _ver{ ver } { }
+        [[nodiscard]] bool stale(size_t ver) const { return _ver != ver; }
+        void rescore(double gain, double cost, size_t ver) { _gain = gain, _cost = cost, _ver = ver; }
+        // Levels gained, plus the log-likelihood of a decisive outcome, less
+        // the log of the expected cost: each level is worth e times the odds,
+        // or e times the cost; an unknown cost counts as 1
+        [[nodiscard]] double priority() const {
+            auto p = static_cast<int64_t>(UD ? get_size() - hier() : hier()) + _bonus;
+            return static_cast<double>(p) + _gain - (_cost > 0.0 ? std::log(_cost) : 0.0);
+        }
         struct hier_cmp {
             bool operator()(const aelem &l, const aelem &r) const {
-                auto lp = (UD ? l.get_size() - l.hier() : l.hier()) + l._bonus;
-                auto rp = (UD ? r.get_size() - r.hier() : r.hier()) + r._bonus;
-                if (lp < rp)
-                    return true;
-                if (lp > rp)
-                    return false;
+                auto lp = l.priority(), rp = r.priority();
+                if (lp != rp)
+                    return lp < rp;
                 return std::lexicographical_compare(l._v.begin(), l._v.end(), r._v.begin(), r._v.end());
             }
         };
@@ -30,14 +50,14 @@ class tri_set {
     typedef std::priority_queue<aelem<false>, std::vector<aelem<false>>, aelem<false>::hier_cmp> dqueue_t;
 
 private:
-    size_t _n;
+    size_t _n{ 0 };
 
     // List of supporting elements confirmed TRUE
     homo_set<true> _us;
     // List of supporting elements confirmed FALSE
     homo_set<false> _ds;
-    // List of elements confirmed IMPROBABLE
-    set_t _zs;
+    // List of elements and intervals confirmed IMPROBABLE
+    cube_set _zs;
 
     // 1) TRUE, supporting, non-inf
     // 2) IMPROBABLE
@@ -51,6 +71,9 @@ private:
     // 4) All _ds elements |
     // 5) _ds.downs().ups()
     dqueue_t _dq;
+    // Candidates from _xt / _xf, drawn once _uq / _dq run dry
+    uqueue_t _xuq;
+    dqueue_t _xdq;
 
     // List of suprema FALSE elements
     set_t _sup;
@@ -59,31 +82,141 @@ private:
 
     // Any modification towards _us/_ds will invalidate these
     // How many levels has been searched
-    size_t _ud, _dd;
+    size_t _ud{ 0 }, _dd{ 0 };
     // List of supporting TRUE + _ud
     // List of supporting FALSE - _dd
     set_t _ul, _dl;
 
+    // Per-parameter evidence, updated by every accepted mark_true/mark_false
+    // _hu: FALSE results blamed on (shared among) the cleared bits
+    // _mu: TRUE results despite the bit being cleared
+    // _hd: TRUE results blamed on (shared among) the set bits
+    // _md: FALSE results despite the bit being set
+    std::vector<double> _hu, _mu, _hd, _md;
+    // Bumped on every update of the model; queued scores are refreshed lazily
+    size_t _ver{ 0 };
+
+    // Least-squares fit of execution cost against hier(): count, sum h, h^2, t, h*t
+    double _cn{ 0.0 }, _ch{ 0.0 }, _chh{ 0.0 }, _ct{ 0.0 }, _cht{ 0.0 };
+
+    // Dualization, for finding all infima / suprema:
+    // _xt: minimal transversals of _us; complemented, the largest
+    //      elements not above any TRUE one: each is either undecided
+    //      or, being FALSE, a supremum
+    // _xf: minimal transversals of the complements of _ds, i.e. the
+    //      smallest elements not below any FALSE one, likewise for infima
+    // A TRUE result on the former leads next_u down to a new infimum, a
+    // FALSE one on the latter leads next_d up to a new supremum, so each
+    // direction alone only runs dry once all of them are found
+    bool _dual{ false };
+    transversals _xt, _xf;
+
+    void dual_true(const elem &el);
+    void dual_false(const elem &el);
+    void push_xu(const elem &el);
+    void push_xd(const elem &el);
+
+    // Only valid elements are ever queued, marked, or neighbors
+    constraints _cs;
+
+    // Changes to _us, _sup, _zs, _inf, _ds, and the caller's running set
+    journal _jr;
+
+    // Direct TRUE / FALSE observations of every marked element
+    struct votes {
+        size_t t, f;
+    };
+    std::unordered_map<elem, votes, elem::hasher> _votes;
+    // Votes (and a majority) needed to settle a conflict; below 2,
+    // conflicting marks are refused instead
+    size_t _quorum{ 1 };
+    // Elements of unsettled conflicts, and those among them short of a quorum
+    set_t _disputed, _rerun;
+    // Re-executions of _rerun, handed out before any other candidate
+    std::deque<elem> _rq;
+    // Marks put in place since the last applied(): TRUE ones, FALSE ones
+    std::vector<elem> _at, _af;
+
+    // 1: TRUE, -1: FALSE, 0: no quorum yet
+    [[nodiscard]] int verdict(const elem &el) const;
+    bool dispute(const elem &el, bool val);
+    bool ballot(const elem &el);
+    void resolve();
+    void retract_true(const elem &el);
+    void retract_false(const elem &el);
+    void redualize();
+
+    void add_true(const elem &el);
+    void add_false(const elem &el);
+    void take_true(const elem &el);
+    void take_false(const elem &el);
+
+    [[nodiscard]] const constraints *filter() const;
+
+    void learn(const elem &el, bool val);
+    template <bool UD>
+    [[nodiscard]] double gain(const elem &el) const;
+    [[nodiscard]] double cost(const elem &el) const;
+    void push_u(const elem &el, int64_t bonus);
+    void push_d(const elem &el, int64_t bonus);
+    // The best undecided element of q, if any
+    template <bool UD, typename Q>
+    [[nodiscard]] elem pop(Q &q);
+
+    // Merge [lo, hi] with whatever improbable interval mirrors it across
+    // one of its fixed bits, as long as there is one
+    void coalesce(const elem &lo, const elem &hi);
+
     bool check_sup(const elem &el);
     bool check_inf(const elem &el);
+    // Queue the candidates around a newly accepted mark
+    void settle_true(const elem &el);
+    void settle_false(const elem &el);
 
 public:
     [[nodiscard]] bool mark_true(const elem &el);
     [[nodiscard]] bool mark_false(const elem &el);
     [[nodiscard]] bool mark_improbable(const elem &el);
+    // Everything in [lo, hi]; only its outer neighbors are queued
+    [[nodiscard]] bool mark_improbable(const elem &lo, const elem &hi);
+    void mark_cost(const elem &el, double t);
+    // Many marks at once, e.g. from an earlier search; returns how many were taken
+    size_t seed(const std::vector<elem> &ts, const std::vector<elem> &fs, const std::vector<elem> &zs);
+    void set_dualize(size_t N, bool dual);
+    // Whether dualization gave up past transversals::cap
+    [[nodiscard]] bool dual_overflow() const;
+    // Re-execute conflicting results until one side has q votes
+    void set_quorum(size_t q);
+    [[nodiscard]] size_t get_quorum() const;
+    // Only before anything is marked
+    [[nodiscard]] bool require(size_t N, size_t i, size_t j);
+    [[nodiscard]] bool exclude(size_t N, size_t i, size_t j);
+    [[nodiscard]] bool merge(size_t N, size_t i, size_t j);
 
     [[nodiscard]] const homo_set<true> &get_us() const;
     [[nodiscard]] const homo_set<false> &get_ds() const;
-    [[nodiscard]] const set_t &get_zs() const;
+    [[nodiscard]] const cube_set &get_zs() const;
     [[nodiscard]] const set_t &get_sup() const;
     [[nodiscard]] const set_t &get_inf() const;
+    [[nodiscard]] const journal &get_journal() const;
+    [[nodiscard]] journal &get_journal();
 
     [[nodiscard]] bool is_decided(const elem &el) const;
+    [[nodiscard]] bool is_disputed(const elem &el) const;
+    [[nodiscard]] const set_t &get_disputed() const;
+    // What the marks since the last call decided, including the winners
+    // of settled conflicts: TRUE ones, FALSE ones
+    std::pair<std::vector<elem>, std::vector<elem>> applied();
 
     elem next_u();
     elem next_d();
+    // Give back a candidate taken by next_u (ud) or next_d that was never decided
+    void requeue(const elem &el, bool ud);
 
     void check_all();
+
+    // Classes of bits that every distinguishing mark says are interchangeable
+    [[nodiscard]] std::vector<std::vector<size_t>> twins() const;
 };
 
 #endif //LATTICE_TRI_SET_HPP
@@ -48,8 +48,36 @@ module.exports.parse = async ({ argFile, inPlace, args }) => {
   return res;
 };
 
-module.exports.hash = (argv, cfg) => {
+// Map a configuration of an earlier run, given by its parameters, onto
+// pars. A parameter no longer there voids it, unless dropping is allowed.
+module.exports.remap = (pars) => {
+  const where = new Map();
+  pars.forEach((p, i) => {
+    if (!where.has(p)) where.set(p, []);
+    where.get(p).push(i);
+  });
+  return (ps, drop) => {
+    const cfg = pars.map(() => '0');
+    const used = new Map();
+    for (const p of ps) {
+      const k = used.get(p) || 0;
+      const l = where.get(p) || [];
+      if (k >= l.length) {
+        if (!drop) return null;
+        continue;
+      }
+      cfg[l[k]] = '1';
+      used.set(p, k + 1);
+    }
+    return cfg.join('');
+  };
+};
+
+// code: what the lattice computed for cfg, if any (see lattice.hash)
+module.exports.hash = (argv, cfg, code) => {
   const program = path.parse(argv.program).base;
+  if (code)
+    return `${program}-${code}`;
   if (cfg.length <= 16 * 1)
     return `${program}-${cfg.length}-0b${cfg}`;
   if (cfg.length <= 16 * 2)
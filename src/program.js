@@ -37,7 +37,8 @@ module.exports.execute = async (argv, p, hash, token = {}) => {
   const fnerr = argv.recordStderr && path.join(argv.output, hash + '.err');
   const fnres = argv.cache && path.join(argv.output, hash + '.res');
 
-  if (fnres) {
+  // A fresh run must not take the cached result it is meant to check
+  if (fnres && !token.fresh) {
     try {
       await fs.access(fnres, fs.constants.R_OK);
       logger.info('Cache file found for execution #', hash);
@@ -229,6 +230,7 @@ module.exports.execute = async (argv, p, hash, token = {}) => {
     logger.notice('Result for execution:', res, hash);
     if (res !== 'cancel') {
       logger.info('Time consumption:', timespan.getString(dur, 'ms'), hash);
+      token.duration = dur;
     }
   } catch (err) {
     resolved = true;